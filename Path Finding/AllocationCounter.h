@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+// Debug builds only: counts calls to the global operator new made on the
+// calling thread. The replacement operators live in AllocationCounter.cpp
+// and forward to the C allocator; release builds keep the default ones.
+#ifdef _DEBUG
+class AllocationCounter
+{
+public:
+	static uint64_t getCount();
+};
+#endif
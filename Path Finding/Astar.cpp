@@ -1,4 +1,5 @@
 ﻿#include "Astar.h"
+#include "Trace.h"
 
 bool Astar::isValid(Position position) {
 	int cols = grid.getDimensions().x; 
@@ -9,30 +10,13 @@ bool Astar::isValid(Position position) {
 	return false;
 }
 
-bool Astar::isUnblocked(Position position) {
-	if (nodes[position.x][position.y].getState() == NodeState::Unblocked)
-		return true;
-	return false;
-}
-
-bool Astar::isDestination(Position position) {
-	if (nodes[position.x][position.y].getState() == NodeState::Target)
-		return true;
-	return false;
+bool Astar::isTraversable(Position position) {
+	return nodes[position.x][position.y].getState() != NodeState::Blocked;
 }
 
 float Astar::calculateHval(Position currentPos) {
-    Position goal(-1, -1);
-
-	for (auto& col : nodes) {
-		for (auto& node : col) {
-			if (node.getState() == NodeState::Target) {
-				goal = node.getWorldPosition(); 
-				break;
-			}
-		}
-		if (goal.x != -1) break;
-	}
+	ProfileTimer timer(profiling, profile.heuristicUs);
+	const Position& goal = goalPos;
 
 	float h = 0.0f;
 
@@ -41,6 +25,13 @@ float Astar::calculateHval(Position currentPos) {
             h = static_cast<float>(std::abs(currentPos.x - goal.x) + std::abs(currentPos.y - goal.y));
 			break;
 
+		case Landmark_ALT:
+			if (landmarks && landmarks->isValid()) {
+				h = landmarks->heuristic(currentPos);
+				break;
+			}
+			[[fallthrough]];
+
 		case Diagonal_Distance: {
 			int dx = std::abs(currentPos.x - goal.x);
 			int dy = std::abs(currentPos.y - goal.y);
@@ -58,261 +49,749 @@ float Astar::calculateHval(Position currentPos) {
 	return h;
 }
 
+float Astar::stepCost(Position from, Position to) {
+    return (from.x != to.x && from.y != to.y) ? 1.414f : 1.0f;
+}
+
+Neighbours Astar::getNeighbours(Position pos) {
+    static const Position straight[4] = { { 0, 1 }, { 1, 0 }, { 0, -1 }, { -1, 0 } };
+    static const Position all[8] = { { 0, 1 }, { 1, 1 }, { 1, 0 }, { 1, -1 }, { 0, -1 }, { -1, -1 }, { -1, 0 }, { -1, 1 } };
+
+    const Position* steps = (method == Manhattan_Distance) ? straight : all;
+    Neighbours neighbours;
+    neighbours.count = (method == Manhattan_Distance) ? 4 : 8;
+    for (int i = 0; i < neighbours.count; ++i)
+        neighbours.cells[i] = pos + steps[i];
+    return neighbours;
+}
+
+// Drops every list before rewinding the arena, since none may outlive it
 void Astar::clearContainers() {
-    openList.clear();
-    closedList.clear();
+    std::destroy_at(&openList);
+    std::destroy_at(&closedList);
+    std::destroy_at(&inconsList);
+    arena.release();
+    std::construct_at(&openList, &arena);
+    std::construct_at(&closedList, &arena);
+    std::construct_at(&inconsList, &arena);
 }
 
 void Astar::resetAstar() {
+    nodesDirty = false;
     for (auto& col : nodes) {
         for (auto& node : col) {
             auto state = node.getState();
-            if (state == NodeState::Path || state == NodeState::Visited)
+            if (state == NodeState::Path || state == NodeState::Visited) {
+                node.setState(NodeState::Unblocked);
                 node.Reset(NodeState::Unblocked);
-            else if (state == NodeState::Target)
+            }
+            else {
                 node.setParent({ -1, -1 });
+                node.setGcost(FLT_MAX);
+                node.setHcost(FLT_MAX);
+                node.setFcost(FLT_MAX);
+            }
         }
     }
 }
 
+// Marks the cells of the last result, an optional consumer of the search
 void Astar::tracePath() {
-    bool foundTarget = false;
-    Position targetPos;
-
-    for (auto& col : nodes) {
-        for (auto& node : col) {
-            if (node.getState() == NodeState::Target) {
-                targetPos = node.getWorldPosition();
-                foundTarget = true;
-                break;
-            }
-        }
-        if (foundTarget)
-            break;
-    }
-
-    Position current = targetPos;
-    while (true) {
-        Node& node = nodes[current.x][current.y];
-
+    nodesDirty = true;
+    for (const auto& position : result.waypoints) {
+        Node& node = nodes[position.x][position.y];
         if (node.getState() != NodeState::Source && node.getState() != NodeState::Target) {
             node.setState(NodeState::Path);
             node.changeColor(NodeState::Path);
         }
-
-        Position parent = node.getParent();
-        if (nodes[parent.x][parent.y].getState() == NodeState::Source) 
-            break;
-  
-        current = parent;
     }
 }
 
+// Adopts a result computed elsewhere (e.g. a preprocessed hierarchy) for display
+void Astar::showResult(const SearchResult& external) {
+    cancelSearch();
+    clearContainers();
+    resetAstar();
+    smoothedPath.clear();
+    anyAngleStats = {};
+    result = external;
+    error = result.error;
+    if (error == NoError && visualize)
+        tracePath();
+}
+
 bool Astar::areEmpty() {
     if (openList.empty() && closedList.empty())
         return true;
     return false;
 }
 
-void Astar::searchPath()
+// Shared setup of every entry point; false if the query is invalid
+bool Astar::beginSearch(Position source, Position target)
 {
+    if (nodesDirty)
+        resetAstar();
     clearContainers();
-    if (!areEmpty()) {
-        std::cout << "Either of the containers not empty!\n";
-        if (!openList.empty())
-            std::cout << "OpenList not empty!\n";
-        else if (!closedList.empty())
-            std::cout << "ClosedList not empty!\n";
-        return;
+    anytimeHistory.clear();
+    smoothedPath.clear();
+    anyAngleStats = AnyAngleStats();
+    smoothingStats = SmoothingStats();
+
+    // Keeps the waypoint buffer's capacity for the next path
+    result.error = NoError;
+    result.waypoints.clear();
+    result.cost = 0.0f;
+    result.expansions = 0;
+    result.timeMs = 0.0f;
+    profile = SearchProfile();
+    profile.query = ++queryCount;
+
+    searchState = SearchState::Idle;
+    error = NoError;
+    epsilon = weight;
+    searchStart = std::chrono::steady_clock::now();
+
+    // Toggling recording mid-search must not log half a search; a rejected
+    // query leaves an empty replay rather than the previous search's
+    activeRecording = nullptr;
+    if (recording)
+        recording->clear();
+
+    if (source == Position(-1, -1) || !isValid(source)) {
+        error = result.error = NoSourceNode;
+        return false;
+    }
+    if (target == Position(-1, -1) || !isValid(target)) {
+        error = result.error = NoTargetNode;
+        return false;
     }
 
-    bool foundDest = false;
+    // Cells in different components can never be joined, so skip the search
+    if (!grid.sameComponent(source, target)) {
+        error = NoPath;
+        searchState = SearchState::NoPath;
+        endSearch();
+        return false;
+    }
 
-    Node* nodeSource = nullptr;
-    for (auto& col : nodes) {
-        for (auto& node : col) {
-            auto state = node.getState();
-            if (state == NodeState::Source) {
-                nodeSource = &node;
-                break;
-            }
-        }
-        if (nodeSource) break;
+    sourcePos = source;
+    goalPos = target;
+    activeRecording = recording;
+    if (activeRecording) {
+        recordingRows = grid.getDimensions().y;
+        activeRecording->begin(grid.getDimensions(), goalPos, method == Manhattan_Distance);
     }
+    if (landmarks)
+        landmarks->setGoal(goalPos);
+    return true;
+}
 
-    if (nodeSource == nullptr) {
-        error = NoSourceNode;
-        return;
+void Astar::endSearch()
+{
+    result.timeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - searchStart).count();
+    result.error = error;
+
+    profile.expanded = result.expansions;
+    profile.totalMs = result.timeMs;
+    if (activeRecording)
+        activeRecording->finish();
+    activeRecording = nullptr;
+    if (profiling) {
+        historyMs[historyHead] = profile.totalMs;
+        historyExpanded[historyHead] = static_cast<float>(profile.expanded);
+        historyHead = (historyHead + 1) % ProfileHistory;
     }
+}
 
-    nodeSource->setFcost(0);
-    nodeSource->setGcost(0);
-    nodeSource->setHcost(0);
-    float f_Source = nodeSource->getFcost();
-    Position gridPos_Source = nodeSource->getWorldPosition();
-    Pair Source = std::make_pair(f_Source, gridPos_Source);
-    openList.insert(Source);
-
-    while (!openList.empty())
-    {
-        auto current = *openList.begin();
-        openList.erase(openList.begin());
-        auto& pos = std::get<1>(current);
-        closedList.insert(pos);
+void Astar::noteGenerated(Position cell, Position from, float g, float h, size_t openSize)
+{
+    ++profile.generated;
+    profile.openPeak = std::max(profile.openPeak, static_cast<int>(openSize));
+    if (activeRecording)
+        activeRecording->push(cell.x * recordingRows + cell.y, from.x < 0 ? -1 : from.x * recordingRows + from.y, g, h);
+}
 
-        float fnew, gnew, hnew;
-
-        struct Directions {
-            Position N = { 0, 1 };
-            Position E = { 1, 0 };
-            Position S = { 0, -1 };
-            Position W = { -1, 0 };
-            Position NE = N + E;
-            Position SE = S + E;
-            Position SW = S + W;
-            Position NW = N + W;
-        }; Directions D;
-
-        std::vector<Position> directions;
-
-        if (method == Manhattan_Distance)
-            directions = { D.N + pos, D.E + pos, D.S + pos, D.W + pos };
-        else
-            directions = { D.N + pos, D.NE + pos, D.E + pos, D.SE + pos, D.S + pos, D.SW + pos, D.W + pos, D.NW + pos };
-
-        for (auto& direction : directions) {
-            if (isValid(direction)) {
-                auto& node = nodes[direction.x][direction.y];
-                if (isDestination(direction)) {
-                    node.setParent(pos);
-                    tracePath();
-                    foundDest = true;
-                    return;
-                }
-                else if (!closedList.contains(direction) && isUnblocked(direction)) {
-                    float cost = (abs(direction.x - pos.x) == 1 && abs(direction.y - pos.y) == 1) ? 1.414f : 1.0f;
-                    gnew = nodes[pos.x][pos.y].getGcost() + cost;
-                    hnew = calculateHval(direction);
-                    fnew = gnew + hnew;
-
-                    if (node.getFcost() == FLT_MAX || node.getFcost() > fnew) {
-                        openList.emplace(std::make_pair(fnew, direction));
-                        node.setParent(pos);
-                        node.setGcost(gnew);
-                        node.setHcost(hnew);
-                        node.setFcost(fnew);
-                        node.setState(NodeState::Visited);
-                        node.changeColor(NodeState::Visited);
-                    }
-                }
-            }
+void Astar::noteExpanded(Position cell)
+{
+    ++result.expansions;
+    if (activeRecording)
+        activeRecording->expand(cell.x * recordingRows + cell.y);
+}
+
+void Astar::noteFound()
+{
+    if (activeRecording)
+        activeRecording->reach(goalPos.x * recordingRows + goalPos.y);
+}
+
+// Pops and expands the best open cell; true once the target is popped
+bool Astar::expandNext()
+{
+    Position pos = openList.begin()->second;
+    openList.erase(openList.begin());
+    if (pos == goalPos) {
+        noteFound();
+        return true;
+    }
+
+    closedList.insert(pos);
+    noteExpanded(pos);
+    float g = nodes[pos.x][pos.y].getGcost();
+
+    ProfileTimer timer(profiling, profile.neighbourUs);
+    for (auto& next : getNeighbours(pos)) {
+        if (!isValid(next) || !isTraversable(next) || closedList.contains(next))
+            continue;
+
+        auto& node = nodes[next.x][next.y];
+        float gnew = g + stepCost(pos, next);
+        if (gnew >= node.getGcost())
+            continue;
+
+        if (node.getFcost() != FLT_MAX)
+            openList.erase(std::make_pair(node.getFcost(), next));
+        node.setParent(pos);
+        node.setGcost(gnew);
+        node.setHcost(calculateHval(next));
+        node.setFcost(gnew + weight * node.getHcost());
+        openList.emplace(node.getFcost(), next);
+        noteGenerated(next, pos, gnew, node.getHcost(), openList.size());
+
+        if (visualize && node.getState() == NodeState::Unblocked) {
+            node.setState(NodeState::Visited);
+            node.changeColor(NodeState::Visited);
         }
     }
+    return false;
 }
 
-void Astar::startSearch(int delay)
+void Astar::pushSource()
 {
-    clearContainers();
+    nodesDirty = true;
+    Node& source = nodes[sourcePos.x][sourcePos.y];
+    source.setGcost(0);
+    source.setHcost(calculateHval(sourcePos));
+    source.setFcost(weight * source.getHcost());
+    openList.emplace(source.getFcost(), sourcePos);
+    noteGenerated(sourcePos, { -1, -1 }, 0.0f, source.getHcost(), openList.size());
+}
 
-    delayMs = delay;
-    isRunning = true;
-    lastStepTime = std::chrono::steady_clock::now();
+void Astar::loadLayout()
+{
+    Position dim = grid.getDimensions();
+    if (layout.order == cellOrder && layout.cols == dim.x && layout.rows == dim.y && layoutVersion == grid.getVersion() && !layoutBlocked.empty())
+        return;
 
-    Node* nodeSource = nullptr;
-    for (auto& col : nodes) {
-        for (auto& node : col) {
-            if (node.getState() == NodeState::Source) {
-                nodeSource = &node;
-                break;
-            }
+    layout = CellLayout(cellOrder, dim.x, dim.y);
+    std::vector<uint8_t> blocked = grid.getBlockedMask();
+    layoutBlocked.assign(layout.size(), 1);
+    for (int x = 0; x < dim.x; ++x)
+        for (int y = 0; y < dim.y; ++y)
+            layoutBlocked[layout.index({ x, y })] = blocked[x * dim.y + y];
+    layoutVersion = grid.getVersion();
+}
+
+// Headless A* on pooled scratch; the nodes are left untouched. Cell state is
+// laid out by cellOrder so a cell's neighbours share cache lines.
+void Astar::searchPooled()
+{
+    loadLayout();
+    Position dim = grid.getDimensions();
+    auto index = [this](Position p) { return layout.index(p); };
+
+    SearchContextLease lease;
+    SearchContext& context = *lease;
+    context.begin(layout.size());
+
+    int goal = index(goalPos);
+    context.setG(index(sourcePos), 0.0f, -1);
+    float h = calculateHval(sourcePos);
+    context.push(weight * h, index(sourcePos));
+    noteGenerated(sourcePos, { -1, -1 }, 0.0f, h, context.size());
+
+    error = NoPath;
+    while (!context.empty()) {
+        int cell = context.pop().second;
+        if (context.isClosed(cell))
+            continue;
+        if (cell == goal) {
+            noteFound();
+            error = NoError;
+            break;
+        }
+        context.close(cell);
+        Position pos = layout.position(cell);
+        noteExpanded(pos);
+
+        float g = context.getG(cell);
+        ProfileTimer timer(profiling, profile.neighbourUs);
+        for (const auto& next : getNeighbours(pos)) {
+            if (next.x < 0 || next.x >= dim.x || next.y < 0 || next.y >= dim.y)
+                continue;
+            int nextCell = index(next);
+            if (layoutBlocked[nextCell])
+                continue;
+            if (context.isClosed(nextCell))
+                continue;
+            float gnew = g + stepCost(pos, next);
+            if (gnew >= context.getG(nextCell))
+                continue;
+            context.setG(nextCell, gnew, cell);
+            float h = calculateHval(next);
+            context.push(gnew + weight * h, nextCell);
+            noteGenerated(next, pos, gnew, h, context.size());
         }
-        if (nodeSource) break;
     }
 
-    if (nodeSource == nullptr) {
-        error = NoSourceNode;
+    if (error != NoError)
         return;
+    for (int cell = goal; cell != -1; cell = context.getParent(cell))
+        result.waypoints.push_back(layout.position(cell));
+    std::reverse(result.waypoints.begin(), result.waypoints.end());
+    result.cost = context.getG(goal);
+    postProcess();
+}
+
+const SearchResult& Astar::searchPath(Position source, Position target)
+{
+    TraceSpan span("Astar::searchPath");
+    if (!beginSearch(source, target))
+        return result;
+
+    if (!visualize) {
+        searchPooled();
+        endSearch();
+        return result;
     }
 
-    nodeSource->setFcost(0);
-    nodeSource->setGcost(0);
-    nodeSource->setHcost(0);
-    float f_Source = nodeSource->getFcost();
-    Position gridPos_Source = nodeSource->getWorldPosition();
-    openList.insert(std::make_pair(f_Source, gridPos_Source));
+    if (!areEmpty()) {
+        std::cout << "Either of the containers not empty!\n";
+        if (!openList.empty())
+            std::cout << "OpenList not empty!\n";
+        else if (!closedList.empty())
+            std::cout << "ClosedList not empty!\n";
+        error = Unknown;
+        endSearch();
+        return result;
+    }
+
+    pushSource();
+    error = NoPath;
+    while (!openList.empty()) {
+        if (expandNext()) {
+            error = NoError;
+            finishPath();
+            break;
+        }
+    }
+
+    endSearch();
+    return result;
 }
 
-bool Astar::stepSearch()
+void Astar::startSearch(Position source, Position target, int delay)
 {
+    delayMs = delay;
+    lastStepTime = std::chrono::steady_clock::now();
+    searchState = SearchState::Idle;
+
+    if (!beginSearch(source, target))
+        return;
+
+    searchState = SearchState::Running;
+    pushSource();
+}
+
+// Advances the animated search by one expansion once the delay has passed
+SearchState Astar::stepSearch()
+{
+    TraceSpan span("Astar::stepSearch");
     using clock = std::chrono::steady_clock;
-    if (!isRunning) return true; 
+    if (searchState != SearchState::Running)
+        return searchState;
 
     auto now = clock::now();
     if (delayMs > 0) {
         auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastStepTime).count();
         if (elapsed < delayMs)
-            return false; 
+            return searchState;
     }
 
     lastStepTime = now; 
 
     if (openList.empty()) {
-        isRunning = false; 
-        return true;
+        error = NoPath;
+        searchState = SearchState::NoPath;
+        endSearch();
+    }
+    else if (expandNext()) {
+        finishPath();
+        searchState = SearchState::Found;
+        endSearch();
     }
 
-    auto current = *openList.begin();
-    openList.erase(openList.begin());
-    auto& pos = std::get<1>(current);
-    closedList.insert(pos);
+    return searchState;
+}
+
+void Astar::cancelSearch()
+{
+    if (searchState != SearchState::Running)
+        return;
+
+    clearContainers();
+    searchState = SearchState::Cancelled;
+    endSearch();
+}
+
+// Lowest unweighted f over OPEN and INCONS, a lower bound on the optimal cost
+float Astar::lowerBound()
+{
+    float bound = FLT_MAX;
+    for (auto& [f, pos] : openList) {
+        auto& node = nodes[pos.x][pos.y];
+        bound = std::min(bound, node.getGcost() + node.getHcost());
+    }
+    for (auto& pos : inconsList) {
+        auto& node = nodes[pos.x][pos.y];
+        bound = std::min(bound, node.getGcost() + node.getHcost());
+    }
+    return bound;
+}
+
+// Moves INCONS into OPEN and re-keys every entry with the new weight
+void Astar::rebuildOpenList(float eps)
+{
+    std::vector<Position> entries;
+    entries.reserve(openList.size() + inconsList.size());
+    for (auto& [f, pos] : openList)
+        entries.push_back(pos);
+    for (auto& pos : inconsList)
+        entries.push_back(pos);
+
+    openList.clear();
+    inconsList.clear();
+    closedList.clear();
 
-    float fnew, gnew, hnew;
+    for (auto& pos : entries) {
+        auto& node = nodes[pos.x][pos.y];
+        node.setFcost(node.getGcost() + eps * node.getHcost());
+        openList.emplace(node.getFcost(), pos);
+    }
+}
 
-    struct Directions {
-        Position N = { 0, 1 };
-        Position E = { 1, 0 };
-        Position S = { 0, -1 };
-        Position W = { -1, 0 };
-        Position NE = N + E;
-        Position SE = S + E;
-        Position SW = S + W;
-        Position NW = N + W;
-    }; Directions D;
+// Expands until the target is proven eps-optimal; false if the deadline hit first
+bool Astar::improvePath(float eps, std::chrono::steady_clock::time_point deadline)
+{
+    Node& goal = nodes[goalPos.x][goalPos.y];
+    int expansions = 0;
 
-    std::vector<Position> directions;
+    while (!openList.empty() && goal.getGcost() > openList.begin()->first) {
+        if ((++expansions & 63) == 0 && std::chrono::steady_clock::now() >= deadline)
+            return false;
 
-    if (method == Manhattan_Distance)
-        directions = { D.N + pos, D.E + pos, D.S + pos, D.W + pos };
-    else
-        directions = { D.N + pos, D.NE + pos, D.E + pos, D.SE + pos, D.S + pos, D.SW + pos, D.W + pos, D.NW + pos };
-
-    for (auto& direction : directions) {
-        if (isValid(direction)) {
-            auto& node = nodes[direction.x][direction.y];
-            if (isDestination(direction)) {
-                node.setParent(pos);
-                tracePath();
-                isRunning = false; 
-                return true;
+        Position pos = openList.begin()->second;
+        openList.erase(openList.begin());
+        closedList.insert(pos);
+        noteExpanded(pos);
+        float g = nodes[pos.x][pos.y].getGcost();
+
+        ProfileTimer timer(profiling, profile.neighbourUs);
+        for (auto& next : getNeighbours(pos)) {
+            if (!isValid(next) || !isTraversable(next))
+                continue;
+
+            auto& node = nodes[next.x][next.y];
+            float gnew = g + stepCost(pos, next);
+            if (gnew >= node.getGcost())
+                continue;
+
+            node.setGcost(gnew);
+            node.setParent(pos);
+
+            if (closedList.contains(next)) {
+                inconsList.insert(next);
+                ++profile.reopened;
+            }
+            else {
+                if (node.getFcost() != FLT_MAX)
+                    openList.erase(std::make_pair(node.getFcost(), next));
+                node.setHcost(calculateHval(next));
+                node.setFcost(gnew + eps * node.getHcost());
+                openList.emplace(node.getFcost(), next);
+                noteGenerated(next, pos, gnew, node.getHcost(), openList.size());
+            }
+
+            if (visualize && node.getState() == NodeState::Unblocked) {
+                node.setState(NodeState::Visited);
+                node.changeColor(NodeState::Visited);
             }
-            else if (!closedList.contains(direction) && isUnblocked(direction)) {
-                float cost = (abs(direction.x - pos.x) == 1 && abs(direction.y - pos.y) == 1) ? 1.414f : 1.0f;
-                gnew = nodes[pos.x][pos.y].getGcost() + cost;
-                hnew = calculateHval(direction);
-                fnew = gnew + hnew;
-
-                if (node.getFcost() == FLT_MAX || node.getFcost() > fnew) {
-                    openList.emplace(std::make_pair(fnew, direction));
-                    node.setParent(pos);
-                    node.setGcost(gnew);
-                    node.setHcost(hnew);
-                    node.setFcost(fnew);
-                    node.setState(NodeState::Visited);
-                    node.changeColor(NodeState::Visited);
+        }
+    }
+    return true;
+}
+
+// ARA*: publishes a weighted solution quickly, then tightens the weight
+// and reuses the previous search effort until the budget runs out
+const SearchResult& Astar::searchAnytime(Position source, Position target, float startWeight, int budgetMs)
+{
+    TraceSpan span("Astar::searchAnytime");
+    using clock = std::chrono::steady_clock;
+    if (!beginSearch(source, target))
+        return result;
+
+    auto start = searchStart;
+    auto deadline = start + std::chrono::milliseconds(budgetMs);
+
+    float eps = std::max(1.0f, startWeight);
+    epsilon = FLT_MAX; // no bound until a path is found
+
+    nodesDirty = true;
+    Node& sourceNode = nodes[sourcePos.x][sourcePos.y];
+    sourceNode.setGcost(0);
+    sourceNode.setHcost(calculateHval(sourcePos));
+    sourceNode.setFcost(eps * sourceNode.getHcost());
+    openList.emplace(sourceNode.getFcost(), sourcePos);
+    noteGenerated(sourcePos, { -1, -1 }, 0.0f, sourceNode.getHcost(), openList.size());
+
+    Node& goal = nodes[goalPos.x][goalPos.y];
+    while (true) {
+        bool complete = improvePath(eps, deadline);
+        if (!complete || goal.getGcost() == FLT_MAX)
+            break;
+
+        float bound = std::min(eps, goal.getGcost() / lowerBound());
+        epsilon = std::max(1.0f, bound);
+        float elapsed = std::chrono::duration<float, std::milli>(clock::now() - start).count();
+        anytimeHistory.push_back({ elapsed, goal.getGcost(), epsilon });
+
+        if (epsilon <= 1.0f || clock::now() >= deadline)
+            break;
+
+        eps = std::max(1.0f, std::min(eps, epsilon) - epsilonStep);
+        rebuildOpenList(eps);
+    }
+
+    if (goal.getGcost() != FLT_MAX) {
+        // Cut short before the first iteration finished, but with a path; bound it against OPEN
+        if (anytimeHistory.empty())
+            epsilon = std::max(1.0f, goal.getGcost() / lowerBound());
+        finishPath();
+    }
+    else if (openList.empty())
+        error = NoPath;
+    else
+        error = TimedOut;
+
+    endSearch();
+    return result;
+}
+
+float Astar::distance(Position a, Position b)
+{
+    float dx = static_cast<float>(a.x - b.x);
+    float dy = static_cast<float>(a.y - b.y);
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+bool Astar::lineOfSight(Position from, Position to)
+{
+    ++anyAngleStats.losChecks;
+    return grid.lineOfSight(from, to);
+}
+
+// Lazy Theta*: the parent was assumed visible on insertion, verify it now
+// and fall back to the best closed neighbour if it is not
+void Astar::setVertex(Position position)
+{
+    auto& node = nodes[position.x][position.y];
+    if (lineOfSight(node.getParent(), position))
+        return;
+
+    float best = FLT_MAX;
+    for (auto& next : getNeighbours(position)) {
+        if (!isValid(next) || !closedList.contains(next))
+            continue;
+
+        float g = nodes[next.x][next.y].getGcost() + distance(next, position);
+        if (g < best) {
+            best = g;
+            node.setParent(next);
+        }
+    }
+    node.setGcost(best);
+}
+
+float Astar::getAnyAngleBaseline()
+{
+    if (anyAngleStats.gridLength < 0.0f && anyAngleStats.length > 0.0f)
+        anyAngleStats.gridLength = gridPathCost(sourcePos, goalPos);
+    return anyAngleStats.gridLength;
+}
+
+// Optimal 8-connected cost on scratch arrays, used as the any-angle baseline
+float Astar::gridPathCost(Position source, Position target)
+{
+    Position dim = grid.getDimensions();
+    std::vector<float> g(static_cast<size_t>(dim.x) * dim.y, FLT_MAX);
+    auto index = [&dim](Position p) { return static_cast<size_t>(p.x) * dim.y + p.y; };
+    auto octile = [&target](Position p) {
+        int dx = std::abs(p.x - target.x);
+        int dy = std::abs(p.y - target.y);
+        return (dx + dy) + (1.414f - 2.0f) * std::min(dx, dy);
+    };
+
+    std::set<Pair, Compare> open;
+    g[index(source)] = 0;
+    open.emplace(octile(source), source);
+
+    while (!open.empty()) {
+        Position pos = open.begin()->second;
+        open.erase(open.begin());
+        if (pos == target)
+            return g[index(pos)];
+
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                Position next = pos + Position(dx, dy);
+                if ((dx == 0 && dy == 0) || !isValid(next) || !isTraversable(next))
+                    continue;
+
+                float gnew = g[index(pos)] + stepCost(pos, next);
+                if (gnew < g[index(next)]) {
+                    if (g[index(next)] != FLT_MAX)
+                        open.erase(std::make_pair(g[index(next)] + octile(next), next));
+                    g[index(next)] = gnew;
+                    open.emplace(gnew + octile(next), next);
                 }
             }
         }
     }
+    return FLT_MAX;
+}
 
-    return false; 
-}
\ No newline at end of file
+const SearchResult& Astar::searchAnyAngle(Position source, Position target)
+{
+    TraceSpan span("Astar::searchAnyAngle");
+    using clock = std::chrono::steady_clock;
+    if (!beginSearch(source, target))
+        return result;
+
+    epsilon = 1.0f;
+    auto start = searchStart;
+
+    nodesDirty = true;
+    Node& sourceNode = nodes[sourcePos.x][sourcePos.y];
+    sourceNode.setParent(sourcePos);
+    sourceNode.setGcost(0);
+    sourceNode.setHcost(distance(sourcePos, goalPos));
+    sourceNode.setFcost(sourceNode.getHcost());
+    openList.emplace(sourceNode.getFcost(), sourcePos);
+    noteGenerated(sourcePos, { -1, -1 }, 0.0f, sourceNode.getHcost(), openList.size());
+
+    bool found = false;
+    while (!openList.empty()) {
+        Position pos = openList.begin()->second;
+        openList.erase(openList.begin());
+
+        setVertex(pos);
+        if (pos == goalPos) {
+            noteFound();
+            found = true;
+            break;
+        }
+        closedList.insert(pos);
+        noteExpanded(pos);
+
+        auto& current = nodes[pos.x][pos.y];
+        Position parent = current.getParent();
+        float parentG = nodes[parent.x][parent.y].getGcost();
+
+        ProfileTimer timer(profiling, profile.neighbourUs);
+        for (auto& next : getNeighbours(pos)) {
+            if (!isValid(next) || !isTraversable(next) || closedList.contains(next))
+                continue;
+
+            // Path 2: inherit the parent of the expanded cell, visibility checked lazily
+            auto& node = nodes[next.x][next.y];
+            float gnew = parentG + distance(parent, next);
+            if (gnew >= node.getGcost())
+                continue;
+
+            if (node.getFcost() != FLT_MAX)
+                openList.erase(std::make_pair(node.getFcost(), next));
+            node.setParent(parent);
+            node.setGcost(gnew);
+            node.setHcost(distance(next, goalPos));
+            node.setFcost(gnew + node.getHcost());
+            openList.emplace(node.getFcost(), next);
+            noteGenerated(next, parent, gnew, node.getHcost(), openList.size());
+
+            if (visualize && node.getState() == NodeState::Unblocked) {
+                node.setState(NodeState::Visited);
+                node.changeColor(NodeState::Visited);
+            }
+        }
+    }
+
+    float seconds = std::chrono::duration<float>(clock::now() - start).count();
+    anyAngleStats.losPerSecond = seconds > 0.0f ? anyAngleStats.losChecks / seconds : 0.0f;
+
+    if (found) {
+        anyAngleStats.length = nodes[goalPos.x][goalPos.y].getGcost();
+        finishPath();
+    }
+    else {
+        error = NoPath;
+    }
+
+    endSearch();
+    return result;
+}
+
+// Parent walk from the target, written source to target; false if the chain is broken
+bool Astar::collectPath(std::vector<Position>& path)
+{
+    path.clear();
+    for (Position p = goalPos; p != sourcePos; p = nodes[p.x][p.y].getParent()) {
+        if (!isValid(p)) {
+            path.clear();
+            return false;
+        }
+        path.push_back(p);
+    }
+    path.push_back(sourcePos);
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+void Astar::finishPath()
+{
+    if (!collectPath(result.waypoints)) {
+        error = NoPath;
+        return;
+    }
+    result.cost = nodes[goalPos.x][goalPos.y].getGcost();
+    postProcess();
+}
+
+// Post-processing stage run once a search reaches the target
+void Astar::postProcess()
+{
+    auto& waypoints = result.waypoints;
+    smoothedPath.clear();
+    smoothingStats = SmoothingStats();
+    smoothingStats.inputCells = static_cast<int>(waypoints.size());
+
+    if (smoothing == No_Smoothing) {
+        if (visualize)
+            tracePath();
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    waypoints = smoother.stringPull(waypoints);
+    if (smoothing == Catmull_Rom)
+        smoothedPath = smoother.catmullRom(waypoints, 8);
+    smoothingStats.timeUs = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+    smoothingStats.outputWaypoints = static_cast<int>(waypoints.size());
+}
@@ -2,13 +2,21 @@
 
 #include "Grid.h"
 #include "Node.h"
+#include "PathSmoother.h"
+#include "Landmarks.h"
+#include "SearchContext.h"
+#include "SearchArena.h"
+#include "SearchRecording.h"
+#include "CellLayout.h"
 #include <vector>
 #include <queue>
 #include <set>
 #include <utility>
 #include <unordered_set>
+#include <memory>
 #include <iostream>
 #include <chrono>
+#include <algorithm>
 #include "imgui.h"
 
 typedef std::pair<float, Position> Pair; // [F, Position]
@@ -30,12 +38,87 @@ struct Compare {
 	}
 };
 
+// Diagnostics of the last any-angle (Lazy Theta*) search
+struct AnyAngleStats {
+	long long losChecks = 0;
+	float losPerSecond = 0.0f;
+	float length = 0.0f;     // euclidean length of the any-angle path
+	float gridLength = -1.0f; // optimal cost of the same query on the 8-connected grid, -1 until asked for
+};
+
+// Cost of the post-processing stage of the last search
+struct SmoothingStats {
+	int inputCells = 0;
+	int outputWaypoints = 0;
+	float timeUs = 0.0f;
+};
+
+// Counters of the last search. Counting is always on; the timers only
+// read the clock while profiling is enabled
+struct SearchProfile {
+	unsigned int query = 0; // sequence number of the search
+	int expanded = 0;
+	int generated = 0;      // insertions into OPEN
+	int reopened = 0;       // closed cells whose cost improved (ARA* INCONS)
+	int openPeak = 0;
+	float heuristicUs = 0.0f;
+	float neighbourUs = 0.0f; // neighbour scans, heuristic calls included
+	float totalMs = 0.0f;
+};
+
+// Adds the lifetime of the scope to a microsecond counter when enabled
+class ProfileTimer
+{
+private:
+	float* target;
+	std::chrono::steady_clock::time_point start;
+
+public:
+	ProfileTimer(bool enabled, float& us) : target(enabled ? &us : nullptr) {
+		if (target)
+			start = std::chrono::steady_clock::now();
+	}
+	~ProfileTimer() {
+		if (target)
+			*target += std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+	}
+};
+
 enum Method {
-	Manhattan_Distance, Diagonal_Distance, Euclidean_Distance, Method_Count
+	Manhattan_Distance, Diagonal_Distance, Euclidean_Distance, Landmark_ALT, Method_Count
 };
 
 enum Error {
-	NoError, Unknown, NoSourceNode
+	NoError, Unknown, NoSourceNode, NoTargetNode, NoPath, TimedOut
+};
+
+// Lifecycle of the animated (step-by-step) search
+enum class SearchState {
+	Idle, Running, Found, NoPath, Cancelled
+};
+
+// Output of one search; visualisation is an optional consumer of it
+struct SearchResult {
+	Error error = NoError;
+	std::vector<Position> waypoints; // source to target, empty when no path was found
+	float cost = 0.0f;
+	int expansions = 0;
+	float timeMs = 0.0f;
+};
+
+// Fixed-capacity neighbour list, so expanding a cell allocates nothing
+struct Neighbours {
+	Position cells[8];
+	int count = 0;
+	const Position* begin() const { return cells; }
+	const Position* end() const { return cells + count; }
+};
+
+// One improved solution published by the anytime (ARA*) search
+struct AnytimeSolution {
+	float timeMs;   // time since the search started
+	float cost;     // g of the target
+	float epsilon;  // proven suboptimality bound of this solution
 };
 
 class Astar
@@ -45,37 +128,134 @@ private:
 
 	// containers
 	std::vector<std::vector<Node>>& nodes;
-	std::set<Pair, Compare> openList;
-	std::unordered_set<Position, Vector2i_Hash> closedList;
+	SearchArena arena; // backs the lists below, rewound by clearContainers
+	std::pmr::set<Pair, Compare> openList{ &arena };
+	std::pmr::unordered_set<Position, Vector2i_Hash> closedList{ &arena };
+	std::pmr::unordered_set<Position, Vector2i_Hash> inconsList{ &arena }; // ARA*: improved while closed
 
-	Method method;
+	Method method = Manhattan_Distance;
+	Landmarks* landmarks = nullptr; // tables for Landmark_ALT, Diagonal_Distance while missing or stale
+	SearchRecording* recording = nullptr; // event log of each search while set
+	SearchRecording* activeRecording = nullptr; // latched by beginSearch for the search under way
+	int recordingRows = 0;
 	Error error;
 
-	bool isRunning = false;
+	Position sourcePos = { -1, -1 };
+	Position goalPos = { -1, -1 };
+	float weight = 1.0f;       // f = g + weight * h
+	float epsilon = 1.0f;      // suboptimality bound of the last solution
+	float epsilonStep = 0.25f; // ARA*: weight decrease per iteration
+	std::vector<AnytimeSolution> anytimeHistory;
+
+	SearchResult result;
+	std::chrono::steady_clock::time_point searchStart;
+	bool visualize = true; // mark Visited/Path cells while searching
+	bool nodesDirty = true; // node costs or colours written since the last reset
+
+	// Headless search state and blocked cells, both in the layout's order
+	CellOrder cellOrder = Column_Major;
+	CellLayout layout;
+	std::vector<uint8_t> layoutBlocked;
+	unsigned int layoutVersion = 0;
+
+	std::vector<Pos> smoothedPath;   // Catmull-Rom curve through the waypoints, in cell units
+	AnyAngleStats anyAngleStats;
+
+	PathSmoother smoother;
+	Smoothing smoothing = No_Smoothing;
+	SmoothingStats smoothingStats;
+
+	SearchProfile profile;
+	bool profiling = false;
+	unsigned int queryCount = 0;
+	static constexpr int ProfileHistory = 120;
+	float historyMs[ProfileHistory] = {};       // ring of total times, newest at historyHead - 1
+	float historyExpanded[ProfileHistory] = {};
+	int historyHead = 0;
+
+	SearchState searchState = SearchState::Idle;
 	std::chrono::steady_clock::time_point lastStepTime;
 	int delayMs = 0;
 
 	// helper functions
 	bool areEmpty();
 	bool isValid(Position position); 
-	bool isUnblocked(Position position); 
-	bool isDestination(Position position); 
+	bool isTraversable(Position position);
 	float calculateHval(Position currentPos);
+	float stepCost(Position from, Position to);
+	Neighbours getNeighbours(Position position);
+
+	// search driver
+	bool beginSearch(Position source, Position target);
+	void endSearch();
+	void pushSource();
+	bool expandNext();
+	// profile and recording hooks shared by every search loop
+	void noteGenerated(Position cell, Position from, float g, float h, size_t openSize);
+	void noteExpanded(Position cell);
+	void noteFound();
+	void searchPooled();
+	void loadLayout(); // reorders the blocked mask after grid edits or a layout change
+
+	// ARA*
+	bool improvePath(float eps, std::chrono::steady_clock::time_point deadline);
+	void rebuildOpenList(float eps);
+	float lowerBound();
+
+	// Lazy Theta*
+	float distance(Position a, Position b);
+	bool lineOfSight(Position from, Position to);
+	void setVertex(Position position);
+	float gridPathCost(Position source, Position target);
+
+	// path output
+	bool collectPath(std::vector<Position>& path);
+	void finishPath();
+	void postProcess();
 
 public:
-	Astar(Grid& _grid) : grid(_grid), nodes(_grid.getNodeData()), error(NoError) {}
+	Astar(Grid& _grid) : grid(_grid), nodes(_grid.getNodeData()), error(NoError), smoother(_grid) {}
 	void clearContainers();
 	void resetAstar();
-	void searchPath();
+	// Each entry point returns the engine's result, valid until the next search
+	const SearchResult& searchPath(Position source, Position target);
+	const SearchResult& searchAnytime(Position source, Position target, float startWeight, int budgetMs);
+	const SearchResult& searchAnyAngle(Position source, Position target);
 
-	void startSearch(int delay);   
-	bool stepSearch();            
-	bool isSearchRunning() const { return isRunning; }
+	void startSearch(Position source, Position target, int delay);   
+	SearchState stepSearch();
+	void cancelSearch();
+	SearchState getSearchState() const { return searchState; }
+	bool isSearchRunning() const { return searchState == SearchState::Running; }
 	void tracePath();
+	void showResult(const SearchResult& external);
 
 	Error getError() { return error; }
+	float getWeight() const { return weight; }
+	float getEpsilon() const { return epsilon; }
+	const std::vector<AnytimeSolution>& getAnytimeHistory() const { return anytimeHistory; }
+	const SearchResult& getResult() const { return result; }
+	const std::vector<Position>& getWaypoints() const { return result.waypoints; }
+	const std::vector<Pos>& getSmoothedPath() const { return smoothedPath; }
+	const AnyAngleStats& getAnyAngleStats() const { return anyAngleStats; }
+	float getAnyAngleBaseline(); // gridLength, searched on first request so it stays out of the query's time
+	const SmoothingStats& getSmoothingStats() const { return smoothingStats; }
+	const SearchArena& getArena() const { return arena; }
+	const SearchProfile& getProfile() const { return profile; }
+	bool isProfiling() const { return profiling; }
+	const float* getHistoryMs() const { return historyMs; }
+	const float* getHistoryExpanded() const { return historyExpanded; }
+	int getHistoryHead() const { return historyHead; }
+	int getHistorySize() const { return ProfileHistory; }
 
 	//setters
 	void setMethod(Method newMethod) { method = newMethod; }
+	void setWeight(float newWeight) { weight = std::max(1.0f, newWeight); }
+	void setSmoothing(Smoothing newSmoothing) { smoothing = newSmoothing; }
+	void setVisualize(bool enabled) { visualize = enabled; }
+	void setCellOrder(CellOrder newOrder) { cellOrder = newOrder; }
+	void setProfiling(bool enabled) { profiling = enabled; }
+	void setLandmarks(Landmarks* newLandmarks) { landmarks = newLandmarks; }
+	void setRecording(SearchRecording* newRecording) { recording = newRecording; }
 };
 
@@ -0,0 +1,256 @@
+#include "Benchmark.h"
+#include "SearchArena.h"
+#include "AllocationCounter.h"
+#include <random>
+#include <set>
+#include <unordered_set>
+#include <memory_resource>
+
+// Dijkstra-order expansion of an unbounded open grid, keeping the open and
+// closed lists busy the way a search does; returns the expansions
+template <typename Open, typename Closed>
+static long long expandOpenGrid(Open& open, Closed& closed, int expansions)
+{
+    static const Position steps[8] = { { 0, 1 }, { 1, 1 }, { 1, 0 }, { 1, -1 }, { 0, -1 }, { -1, -1 }, { -1, 0 }, { -1, 1 } };
+
+    long long expanded = 0;
+    open.emplace(0.0f, Position(0, 0));
+    while (expanded < expansions && !open.empty()) {
+        auto [f, pos] = *open.begin();
+        open.erase(open.begin());
+        if (!closed.insert(pos).second)
+            continue;
+        ++expanded;
+        for (const auto& step : steps)
+            if (!closed.contains(pos + step))
+                open.emplace(f + (step.x && step.y ? 1.414f : 1.0f), pos + step);
+    }
+    return expanded;
+}
+
+// One timed query, including the teardown of its lists
+template <typename Query>
+static BenchmarkRow timeOnce(const std::string& name, Query query)
+{
+    BenchmarkRow row;
+    row.name = name;
+    auto start = std::chrono::steady_clock::now();
+    row.expansions = query();
+    row.avgUs = row.maxUs = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+    row.queries = row.solved = 1;
+    return row;
+}
+
+std::vector<Scenario> Benchmark::randomScenarios(Grid& grid, int count, unsigned int seed)
+{
+    std::vector<Position> free;
+    Position dim = grid.getDimensions();
+    for (int x = 0; x < dim.x; ++x)
+        for (int y = 0; y < dim.y; ++y)
+            if (!grid.isBlocked({ x, y }))
+                free.emplace_back(x, y);
+
+    std::vector<Scenario> scenarios;
+    if (free.size() < 2)
+        return scenarios;
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> pick(0, free.size() - 1);
+    while (static_cast<int>(scenarios.size()) < count) {
+        Position source = free[pick(rng)];
+        Position target = free[pick(rng)];
+        if (source != target)
+            scenarios.push_back({ source, target });
+    }
+    return scenarios;
+}
+
+std::vector<BenchmarkRow> Benchmark::containerAllocators(int expansions)
+{
+    std::vector<BenchmarkRow> rows;
+    rows.push_back(timeOnce("Lists (std::allocator)", [expansions]() {
+        std::set<Pair, Compare> open;
+        std::unordered_set<Position, Vector2i_Hash> closed;
+        return expandOpenGrid(open, closed, expansions);
+    }));
+
+    SearchArena arena;
+    for (const char* name : { "Lists (arena, first)", "Lists (arena, warm)" }) {
+        rows.push_back(timeOnce(name, [&arena, expansions]() {
+            long long expanded;
+            {
+                std::pmr::set<Pair, Compare> open(&arena);
+                std::pmr::unordered_set<Position, Vector2i_Hash> closed(&arena);
+                expanded = expandOpenGrid(open, closed, expansions);
+            }
+            arena.release();
+            return expanded;
+        }));
+    }
+    return rows;
+}
+
+// Octile A* over a blocked mask stored in the layout's order, on the same
+// context a pooled search uses; returns the expansions
+static long long searchLayout(const CellLayout& layout, const std::vector<uint8_t>& blocked, Position source, Position target, SearchContext& context, float& cost)
+{
+    static const Position steps[8] = { { 0, 1 }, { 1, 1 }, { 1, 0 }, { 1, -1 }, { 0, -1 }, { -1, -1 }, { -1, 0 }, { -1, 1 } };
+    auto octile = [&target](Position p) {
+        int dx = std::abs(p.x - target.x);
+        int dy = std::abs(p.y - target.y);
+        return 1.414f * std::min(dx, dy) + static_cast<float>(std::abs(dx - dy));
+    };
+
+    context.begin(layout.size());
+    int goal = layout.index(target);
+    context.setG(layout.index(source), 0.0f, -1);
+    context.push(octile(source), layout.index(source));
+    long long expanded = 0;
+    cost = FLT_MAX;
+    while (!context.empty()) {
+        int cell = context.pop().second;
+        if (context.isClosed(cell))
+            continue;
+        if (cell == goal) {
+            cost = context.getG(cell);
+            break;
+        }
+        context.close(cell);
+        ++expanded;
+
+        Position pos = layout.position(cell);
+        float g = context.getG(cell);
+        for (const auto& step : steps) {
+            Position next = pos + step;
+            if (next.x < 0 || next.x >= layout.cols || next.y < 0 || next.y >= layout.rows)
+                continue;
+            int nextCell = layout.index(next);
+            if (blocked[nextCell] || context.isClosed(nextCell))
+                continue;
+            float gnew = g + (step.x && step.y ? 1.414f : 1.0f);
+            if (gnew >= context.getG(nextCell))
+                continue;
+            context.setG(nextCell, gnew, cell);
+            context.push(gnew + octile(next), nextCell);
+        }
+    }
+    return expanded;
+}
+
+enum MapKind { Open_Map, Random_Map, Rooms_Map, Maze_Map, MapKind_Count };
+
+// [x * size + y]
+static std::vector<uint8_t> generateMap(MapKind kind, int size, std::mt19937& rng)
+{
+    std::vector<uint8_t> blocked(static_cast<size_t>(size) * size, 0);
+    auto at = [&](int x, int y) -> uint8_t& { return blocked[static_cast<size_t>(x) * size + y]; };
+
+    if (kind == Random_Map) {
+        std::bernoulli_distribution wall(0.3);
+        for (auto& cell : blocked)
+            cell = wall(rng);
+    }
+    else if (kind == Rooms_Map) {
+        // 32-cell rooms, each wall segment with a two-cell door somewhere along it
+        const int room = 32;
+        std::uniform_int_distribution<int> door(1, room - 3);
+        for (int x = 0; x < size; ++x)
+            for (int y = 0; y < size; ++y)
+                at(x, y) = (x % room == 0 || y % room == 0);
+        for (int a = room; a < size; a += room) // the outer walls stay closed
+            for (int b = 0; b + 1 < size; b += room) {
+                int d = b + door(rng);
+                for (int i = d; i < std::min(size, d + 2); ++i) {
+                    at(a, i) = 0;
+                    at(i, a) = 0;
+                }
+            }
+    }
+    else if (kind == Maze_Map) {
+        // Depth-first maze on the odd cells, passages one cell wide
+        std::fill(blocked.begin(), blocked.end(), 1);
+        int cells = (size - 1) / 2;
+        std::vector<uint8_t> seen(static_cast<size_t>(cells) * cells, 0);
+        std::vector<Position> stack = { { 0, 0 } };
+        seen[0] = 1;
+        at(1, 1) = 0;
+        const Position sides[4] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+        while (!stack.empty()) {
+            Position cell = stack.back();
+            Position options[4];
+            int count = 0;
+            for (const auto& side : sides) {
+                Position next = cell + side;
+                if (next.x >= 0 && next.x < cells && next.y >= 0 && next.y < cells && !seen[next.x * cells + next.y])
+                    options[count++] = next;
+            }
+            if (count == 0) {
+                stack.pop_back();
+                continue;
+            }
+            Position next = options[std::uniform_int_distribution<int>(0, count - 1)(rng)];
+            seen[next.x * cells + next.y] = 1;
+            at(cell.x + next.x + 1, cell.y + next.y + 1) = 0; // the wall between them
+            at(2 * next.x + 1, 2 * next.y + 1) = 0;
+            stack.push_back(next);
+        }
+    }
+    return blocked;
+}
+
+std::vector<BenchmarkRow> Benchmark::cellLayouts(int size, int queries)
+{
+    const char* mapNames[MapKind_Count] = { "open", "random 30%", "rooms", "maze" };
+    const char* orderNames[CellOrder_Count] = { "Column-major", "Row-major", "Tiled 8x8" };
+
+    std::vector<BenchmarkRow> rows;
+    SearchContext context;
+    for (int kind = 0; kind < MapKind_Count; ++kind) {
+        std::mt19937 rng(17 + kind);
+        std::vector<uint8_t> blocked = generateMap(static_cast<MapKind>(kind), size, rng);
+
+        std::vector<Scenario> scenarios;
+        std::uniform_int_distribution<int> coordinate(0, size - 1);
+        while (static_cast<int>(scenarios.size()) < queries) {
+            Position source(coordinate(rng), coordinate(rng)), target(coordinate(rng), coordinate(rng));
+            if (!blocked[static_cast<size_t>(source.x) * size + source.y] && !blocked[static_cast<size_t>(target.x) * size + target.y] && source != target)
+                scenarios.push_back({ source, target });
+        }
+
+        for (int order = 0; order < CellOrder_Count; ++order) {
+            CellLayout layout(static_cast<CellOrder>(order), size, size);
+            std::vector<uint8_t> ordered(layout.size(), 1);
+            for (int x = 0; x < size; ++x)
+                for (int y = 0; y < size; ++y)
+                    ordered[layout.index({ x, y })] = blocked[static_cast<size_t>(x) * size + y];
+
+            float cost;
+            searchLayout(layout, ordered, scenarios.front().source, scenarios.front().target, context, cost); // warm the context
+
+            BenchmarkRow row = run(std::string(orderNames[order]) + ", " + mapNames[kind], scenarios, [&](Position source, Position target) {
+                SearchResult result;
+                result.expansions = static_cast<int>(searchLayout(layout, ordered, source, target, context, result.cost));
+                result.error = result.cost == FLT_MAX ? NoPath : NoError;
+                return result;
+            });
+            rows.push_back(row);
+        }
+    }
+    return rows;
+}
+
+#ifdef _DEBUG
+uint64_t Benchmark::headlessAllocations(Astar& a_star, const std::vector<Scenario>& scenarios)
+{
+    a_star.setVisualize(false);
+    for (const auto& scenario : scenarios)
+        a_star.searchPath(scenario.source, scenario.target);
+
+    uint64_t before = AllocationCounter::getCount();
+    for (const auto& scenario : scenarios)
+        a_star.searchPath(scenario.source, scenario.target);
+    uint64_t allocations = AllocationCounter::getCount() - before;
+    a_star.setVisualize(true);
+    return allocations;
+}
+#endif
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Grid.h"
+#include "Astar.h"
+#include <vector>
+#include <string>
+#include <chrono>
+
+struct Scenario {
+	Position source;
+	Position target;
+};
+
+// Aggregate of one engine over a scenario set
+struct BenchmarkRow {
+	std::string name;
+	int queries = 0;
+	int solved = 0;
+	float avgUs = 0.0f;
+	float maxUs = 0.0f;
+	double totalCost = 0.0;
+	long long expansions = 0;
+};
+
+class Benchmark
+{
+public:
+	// Pairs of distinct free cells, reproducible for a given seed
+	static std::vector<Scenario> randomScenarios(Grid& grid, int count, unsigned int seed);
+
+	// A* list traffic on an open grid with std::set/unordered_set, once with the
+	// default allocator and twice on a SearchArena (first and warm query)
+	static std::vector<BenchmarkRow> containerAllocators(int expansions);
+
+	// Headless A* on generated size x size maps (open, random, rooms, maze)
+	// with the search state in each CellOrder; only the memory order differs
+	static std::vector<BenchmarkRow> cellLayouts(int size, int queries);
+
+#ifdef _DEBUG
+	// Heap allocations on this thread over the scenarios run as warm headless
+	// searches, after one pass to size the pooled scratch; 0 when pooling holds
+	static uint64_t headlessAllocations(Astar& a_star, const std::vector<Scenario>& scenarios);
+#endif
+
+	template <typename Query>
+	static BenchmarkRow run(const std::string& name, const std::vector<Scenario>& scenarios, Query query) {
+		BenchmarkRow row;
+		row.name = name;
+		double totalUs = 0.0;
+		for (const auto& scenario : scenarios) {
+			auto start = std::chrono::steady_clock::now();
+			SearchResult result = query(scenario.source, scenario.target);
+			float us = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+			++row.queries;
+			totalUs += us;
+			row.maxUs = std::max(row.maxUs, us);
+			row.expansions += result.expansions;
+			if (result.error == NoError) {
+				++row.solved;
+				row.totalCost += result.cost;
+			}
+		}
+		row.avgUs = row.queries > 0 ? static_cast<float>(totalUs / row.queries) : 0.0f;
+		return row;
+	}
+
+	// Times an edit-and-update per cell; every edit counts as solved
+	template <typename Edit>
+	static BenchmarkRow runEdits(const std::string& name, const std::vector<Position>& cells, Edit edit) {
+		BenchmarkRow row;
+		row.name = name;
+		double totalUs = 0.0;
+		for (const auto& cell : cells) {
+			auto start = std::chrono::steady_clock::now();
+			edit(cell);
+			float us = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+			++row.queries;
+			++row.solved;
+			totalUs += us;
+			row.maxUs = std::max(row.maxUs, us);
+		}
+		row.avgUs = row.queries > 0 ? static_cast<float>(totalUs / row.queries) : 0.0f;
+		return row;
+	}
+};
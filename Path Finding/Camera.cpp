@@ -0,0 +1,51 @@
+#include "Camera.h"
+#include <algorithm>
+
+Camera::Camera(const sf::RenderWindow& window, Pos _areaSize) : areaSize(_areaSize)
+{
+    sf::Vector2u windowSize = window.getSize();
+    view.setViewport({ 0.0f, 0.0f, areaSize.x / windowSize.x, areaSize.y / windowSize.y });
+    reset();
+}
+
+void Camera::reset()
+{
+    zoom = 1.0f;
+    view.setSize(areaSize);
+    view.setCenter(areaSize / 2.0f);
+}
+
+void Camera::frame(Pos worldSize)
+{
+    zoom = std::clamp(std::max(worldSize.x / areaSize.x, worldSize.y / areaSize.y), minZoom, maxZoom);
+    view.setSize(areaSize * zoom);
+    view.setCenter(worldSize / 2.0f);
+}
+
+void Camera::handleEvent(const sf::Event& event, const sf::RenderWindow& window)
+{
+    if (event.type == sf::Event::MouseWheelScrolled) {
+        sf::Vector2i pixel(event.mouseWheelScroll.x, event.mouseWheelScroll.y);
+        if (!containsPixel(pixel))
+            return;
+
+        // Keep the point under the cursor where it is
+        float factor = event.mouseWheelScroll.delta > 0 ? 0.8f : 1.25f;
+        float newZoom = std::clamp(zoom * factor, minZoom, maxZoom);
+        Pos before = window.mapPixelToCoords(pixel, view);
+        view.setSize(areaSize * newZoom);
+        zoom = newZoom;
+        view.move(before - window.mapPixelToCoords(pixel, view));
+    }
+    else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Middle) {
+        dragPixel = { event.mouseButton.x, event.mouseButton.y };
+        dragging = containsPixel(dragPixel);
+    }
+    else if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Middle)
+        dragging = false;
+    else if (event.type == sf::Event::MouseMoved && dragging) {
+        sf::Vector2i pixel(event.mouseMove.x, event.mouseMove.y);
+        view.move(Pos(static_cast<float>(dragPixel.x - pixel.x), static_cast<float>(dragPixel.y - pixel.y)) * zoom);
+        dragPixel = pixel;
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include "Node.h"
+
+// Pan and zoom over the grid through an sf::View. The view is shown in the
+// part of the window left of the GUI; the mouse wheel zooms about the
+// cursor and dragging with the middle button pans.
+class Camera
+{
+private:
+	sf::View view;
+	Pos areaSize;
+	float zoom = 1.0f; // world units per pixel
+	bool dragging = false;
+	sf::Vector2i dragPixel;
+
+	static constexpr float minZoom = 1.0f / 8.0f;
+	static constexpr float maxZoom = 128.0f;
+
+public:
+	Camera(const sf::RenderWindow& window, Pos _areaSize);
+
+	void handleEvent(const sf::Event& event, const sf::RenderWindow& window);
+	void reset();                // the grid area as it was before any zoom
+	void frame(Pos worldSize);   // fits the whole map, keeping the aspect
+
+	bool containsPixel(sf::Vector2i pixel) const { return pixel.x >= 0 && pixel.y >= 0 && pixel.x < areaSize.x && pixel.y < areaSize.y; }
+	const sf::View& getView() const { return view; }
+	float getZoom() const { return zoom; }
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Node.h"
+
+enum CellOrder {
+	Column_Major, Row_Major, Tiled_8x8, CellOrder_Count
+};
+
+// Where each cell's entry sits in a flat per-cell array. Column- and
+// row-major keep only one axis of neighbours adjacent; 8 x 8 tiles keep
+// each block in 64 consecutive slots, so the 8-neighbourhood of a cell
+// spans at most four tiles and usually one. Tiles pad the array to whole
+// blocks, so size() can exceed cols * rows.
+struct CellLayout {
+	CellOrder order = Column_Major;
+	int cols = 0, rows = 0;
+	int tileRows = 0; // tiles per column of tiles
+
+	CellLayout() = default;
+	CellLayout(CellOrder _order, int _cols, int _rows) : order(_order), cols(_cols), rows(_rows), tileRows((_rows + 7) / 8) {}
+
+	int size() const { return order == Tiled_8x8 ? ((cols + 7) / 8) * tileRows * 64 : cols * rows; }
+
+	int index(Position p) const {
+		switch (order) {
+		case Row_Major: return p.y * cols + p.x;
+		case Tiled_8x8: return ((p.x >> 3) * tileRows + (p.y >> 3)) << 6 | (p.x & 7) << 3 | (p.y & 7);
+		default: return p.x * rows + p.y;
+		}
+	}
+
+	Position position(int slot) const {
+		switch (order) {
+		case Row_Major: return { slot % cols, slot / cols };
+		case Tiled_8x8: {
+			int tile = slot >> 6;
+			return { (tile / tileRows) * 8 + ((slot >> 3) & 7), (tile % tileRows) * 8 + (slot & 7) };
+		}
+		default: return { slot / rows, slot % rows };
+		}
+	}
+};
@@ -0,0 +1,386 @@
+#include "ConflictBasedSearch.h"
+#include <set>
+#include <tuple>
+#include <queue>
+#include <climits>
+#include <unordered_map>
+#include <unordered_set>
+
+static const Position moves[5] = { { 0, 0 }, { 0, 1 }, { 1, 0 }, { 0, -1 }, { -1, 0 } };
+
+static uint64_t key(int time, int cell)
+{
+    return static_cast<uint64_t>(time) << 32 | static_cast<uint32_t>(cell);
+}
+
+// Open list with a focal sublist holding every entry whose admission value
+// is within the weight of the smallest bound in open, popped fewest
+// conflicts first. With a weight of 1 this is best-first with conflicts
+// as the tie-breaker.
+class FocalQueue
+{
+private:
+    struct Item {
+        int bound, admit, conflicts;
+    };
+
+    float weight;
+    std::vector<Item> items; // by id
+    std::set<std::pair<int, int>> open;                // [bound, id]
+    std::set<std::pair<int, int>> waiting;             // [admit, id], not yet in focal
+    std::set<std::tuple<int, int, int>> focal;         // [conflicts, admit, id]
+
+public:
+    explicit FocalQueue(float _weight) : weight(_weight) {}
+
+    bool empty() const { return open.empty(); }
+    int minBound() const { return open.begin()->first; }
+
+    void push(int id, int bound, int admit, int conflicts) {
+        if (id >= static_cast<int>(items.size()))
+            items.resize(id + 1);
+        items[id] = { bound, admit, conflicts };
+        open.emplace(bound, id);
+        if (admit <= weight * minBound())
+            focal.emplace(conflicts, admit, id);
+        else
+            waiting.emplace(admit, id);
+    }
+
+    int pop() {
+        float threshold = weight * minBound();
+        while (!waiting.empty() && waiting.begin()->first <= threshold) {
+            int id = waiting.begin()->second;
+            waiting.erase(waiting.begin());
+            focal.emplace(items[id].conflicts, items[id].admit, id);
+        }
+
+        int id;
+        if (!focal.empty()) {
+            id = std::get<2>(*focal.begin());
+            focal.erase(focal.begin());
+        }
+        else {
+            id = open.begin()->second;
+            waiting.erase({ items[id].admit, id });
+        }
+        open.erase({ items[id].bound, id });
+        return id;
+    }
+};
+
+void ConflictBasedSearch::setMap(Grid& grid)
+{
+    Position dim = grid.getDimensions();
+    cols = dim.x;
+    rows = dim.y;
+    blocked = grid.getBlockedMask();
+}
+
+void ConflictBasedSearch::setMap(const MapfScenario& scenario)
+{
+    cols = scenario.cols;
+    rows = scenario.rows;
+    blocked = scenario.blocked;
+}
+
+// Unit-cost BFS from every goal, the exact low-level heuristic
+void ConflictBasedSearch::computeDistances()
+{
+    goalDistance.assign(agents.size(), {});
+    std::unordered_map<int, int> byGoal; // agents sharing a goal share the BFS
+    for (size_t a = 0; a < agents.size(); ++a) {
+        int goal = index(agents[a].goal);
+        auto shared = byGoal.find(goal);
+        if (shared != byGoal.end()) {
+            goalDistance[a] = goalDistance[shared->second];
+            continue;
+        }
+        byGoal[goal] = static_cast<int>(a);
+
+        std::vector<int>& distance = goalDistance[a];
+        distance.assign(static_cast<size_t>(cols) * rows, INT_MAX);
+        std::queue<int> queue;
+        distance[goal] = 0;
+        queue.push(goal);
+        while (!queue.empty()) {
+            int cell = queue.front();
+            queue.pop();
+            Position pos = position(cell);
+            for (int m = 1; m < 5; ++m) {
+                Position next = pos + moves[m];
+                if (next.x < 0 || next.x >= cols || next.y < 0 || next.y >= rows || blocked[index(next)] || distance[index(next)] != INT_MAX)
+                    continue;
+                distance[index(next)] = distance[cell] + 1;
+                queue.push(index(next));
+            }
+        }
+    }
+}
+
+// Space-time A* for one agent under the constraints on the node's chain.
+// Ties, and with ECBS the whole focal list, prefer paths that conflict
+// least with the other agents' current paths.
+bool ConflictBasedSearch::planAgent(int agent, const HighNode& node, std::shared_ptr<const Path>& path, int& lowerBound)
+{
+    int start = index(agents[agent].start);
+    int goal = index(agents[agent].goal);
+    const std::vector<int>& h = goalDistance[agent];
+    if (h[start] == INT_MAX)
+        return false;
+
+    std::set<std::pair<int, int>> vertexConstraints;          // [time, cell]
+    std::set<std::tuple<int, int, int>> edgeConstraints;      // [time, from, cell]
+    int goalHold = 0; // the agent may only settle on its goal from this time on
+    for (const HighNode* n = &node; n; n = n->parent.get()) {
+        const Constraint& c = n->constraint;
+        if (c.agent != agent)
+            continue;
+        if (c.from == -1) {
+            vertexConstraints.emplace(c.time, c.cell);
+            if (c.cell == goal)
+                goalHold = std::max(goalHold, c.time + 1);
+        }
+        else
+            edgeConstraints.emplace(c.time, c.from, c.cell);
+    }
+
+    // Where the other agents are, to count the conflicts a move would add
+    std::unordered_map<uint64_t, int> occupant;
+    std::unordered_map<int, int> settled; // goal cell -> time an agent settles there
+    for (int other = 0; other < static_cast<int>(node.paths.size()); ++other) {
+        if (other == agent || !node.paths[other])
+            continue;
+        const Path& p = *node.paths[other];
+        for (int t = 0; t < static_cast<int>(p.size()); ++t)
+            occupant.emplace(key(t, p[t]), other);
+        settled.emplace(p.back(), static_cast<int>(p.size()) - 1);
+    }
+    auto at = [&node](int other, int t) {
+        const Path& p = *node.paths[other];
+        return p[std::min<size_t>(t, p.size() - 1)];
+    };
+    auto conflictsOf = [&](int from, int cell, int t) {
+        int count = 0;
+        auto found = occupant.find(key(t, cell));
+        auto still = settled.find(cell);
+        if (found != occupant.end() || (still != settled.end() && still->second <= t))
+            ++count;
+        if (from != cell) {
+            auto before = occupant.find(key(t - 1, cell));
+            if (before != occupant.end() && at(before->second, t) == from)
+                ++count;
+        }
+        return count;
+    };
+
+    struct State {
+        int cell, time, conflicts, parent;
+    };
+    std::vector<State> states;
+    std::unordered_set<uint64_t> seen;
+    FocalQueue queue(suboptimality);
+    int maxTime = goalHold + cols * rows;
+
+    states.push_back({ start, 0, 0, -1 });
+    seen.insert(key(0, start));
+    queue.push(0, h[start], h[start], 0);
+
+    while (!queue.empty()) {
+        if ((++lowLevelExpansions & 1023) == 0 && std::chrono::steady_clock::now() >= deadline) {
+            timedOut = true;
+            return false;
+        }
+
+        int bound = queue.minBound();
+        int id = queue.pop();
+        State state = states[id];
+        if (state.cell == goal && state.time >= goalHold) {
+            auto result = std::make_shared<Path>(state.time + 1);
+            for (int s = id; s != -1; s = states[s].parent)
+                (*result)[states[s].time] = states[s].cell;
+            path = result;
+            lowerBound = bound;
+            return true;
+        }
+        if (state.time >= maxTime)
+            continue;
+
+        Position pos = position(state.cell);
+        int t = state.time + 1;
+        for (const auto& move : moves) {
+            Position next = pos + move;
+            if (next.x < 0 || next.x >= cols || next.y < 0 || next.y >= rows || blocked[index(next)])
+                continue;
+            int cell = index(next);
+            if (h[cell] == INT_MAX || vertexConstraints.count({ t, cell }) || edgeConstraints.count({ t, state.cell, cell }))
+                continue;
+            if (!seen.insert(key(t, cell)).second)
+                continue;
+
+            int conflicts = state.conflicts + conflictsOf(state.cell, cell, t);
+            states.push_back({ cell, t, conflicts, id });
+            queue.push(static_cast<int>(states.size()) - 1, t + h[cell], t + h[cell], conflicts);
+        }
+    }
+    return false;
+}
+
+// Vertex and edge conflicts between all pairs, timestep by timestep; the
+// first one found is reported
+int ConflictBasedSearch::countConflicts(const std::vector<std::shared_ptr<const Path>>& paths, Conflict* first) const
+{
+    size_t horizon = 0;
+    for (const auto& path : paths)
+        horizon = std::max(horizon, path->size());
+    auto at = [&paths](int agent, size_t t) {
+        const Path& p = *paths[agent];
+        return p[std::min(t, p.size() - 1)];
+    };
+
+    int count = 0;
+    std::unordered_map<int, int> previous, current; // cell -> agent
+    for (size_t t = 0; t < horizon; ++t) {
+        current.clear();
+        for (int agent = 0; agent < static_cast<int>(paths.size()); ++agent) {
+            int cell = at(agent, t);
+            auto [placed, fresh] = current.emplace(cell, agent);
+            if (!fresh) {
+                if (count++ == 0 && first)
+                    *first = { placed->second, agent, -1, cell, static_cast<int>(t) };
+                continue;
+            }
+            if (t == 0)
+                continue;
+            int from = at(agent, t - 1);
+            auto crossing = previous.find(cell);
+            if (from != cell && crossing != previous.end() && crossing->second != agent && at(crossing->second, t) == from) {
+                if (crossing->second > agent)
+                    continue; // counted once, from the other side
+                if (count++ == 0 && first)
+                    *first = { agent, crossing->second, from, cell, static_cast<int>(t) };
+            }
+        }
+        std::swap(previous, current);
+    }
+    return count;
+}
+
+bool ConflictBasedSearch::solve(const std::vector<MapfAgent>& newAgents, float newSuboptimality, int timeLimitMs)
+{
+    auto start = std::chrono::steady_clock::now();
+    deadline = start + std::chrono::milliseconds(timeLimitMs);
+    timedOut = false;
+    solved = false;
+    agents = newAgents;
+    suboptimality = std::max(1.0f, newSuboptimality);
+    solution.clear();
+    solutionCost = 0;
+    highLevelNodes = 0;
+    lowLevelExpansions = 0;
+    computeDistances();
+
+    auto finish = [&](bool found) {
+        solveMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        solved = found;
+        return found;
+    };
+
+    int count = static_cast<int>(agents.size());
+    auto root = std::make_shared<HighNode>();
+    root->paths.resize(count);
+    root->lowerBounds.resize(count);
+    for (int agent = 0; agent < count; ++agent) {
+        if (!planAgent(agent, *root, root->paths[agent], root->lowerBounds[agent]))
+            return finish(false);
+        root->cost += static_cast<int>(root->paths[agent]->size()) - 1;
+        root->lowerBound += root->lowerBounds[agent];
+    }
+    root->conflicts = countConflicts(root->paths, nullptr);
+
+    std::vector<std::shared_ptr<const HighNode>> nodes = { root };
+    FocalQueue queue(suboptimality);
+    queue.push(0, root->lowerBound, root->cost, root->conflicts);
+
+    while (!queue.empty()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            timedOut = true;
+            return finish(false);
+        }
+        std::shared_ptr<const HighNode> node = nodes[queue.pop()];
+        ++highLevelNodes;
+
+        Conflict conflict;
+        if (countConflicts(node->paths, &conflict) == 0) {
+            for (const auto& path : node->paths)
+                solution.push_back(*path);
+            solutionCost = node->cost;
+            return finish(true);
+        }
+
+        for (int side = 0; side < 2; ++side) {
+            auto child = std::make_shared<HighNode>();
+            child->parent = node;
+            child->paths = node->paths;
+            child->lowerBounds = node->lowerBounds;
+            Constraint& c = child->constraint;
+            c.time = conflict.time;
+            if (side == 0) {
+                c.agent = conflict.first;
+                c.from = conflict.from;
+                c.cell = conflict.cell;
+            }
+            else {
+                c.agent = conflict.second;
+                c.from = conflict.from == -1 ? -1 : conflict.cell;
+                c.cell = conflict.from == -1 ? conflict.cell : conflict.from;
+            }
+
+            int agent = c.agent;
+            if (!planAgent(agent, *child, child->paths[agent], child->lowerBounds[agent])) {
+                if (timedOut)
+                    return finish(false);
+                continue;
+            }
+            child->cost = node->cost - static_cast<int>(node->paths[agent]->size()) + static_cast<int>(child->paths[agent]->size());
+            child->lowerBound = node->lowerBound - node->lowerBounds[agent] + child->lowerBounds[agent];
+            child->conflicts = countConflicts(child->paths, nullptr);
+
+            nodes.push_back(child);
+            queue.push(static_cast<int>(nodes.size()) - 1, child->lowerBound, child->cost, child->conflicts);
+        }
+    }
+    return finish(false);
+}
+
+std::vector<BenchmarkRow> ConflictBasedSearch::sweep(const MapfScenario& scenario, int step, int maxAgents, float newSuboptimality, int timeLimitMs)
+{
+    setMap(scenario);
+    std::vector<BenchmarkRow> rows;
+    int last = std::min(maxAgents, static_cast<int>(scenario.agents.size()));
+    for (int k = std::max(1, step); k <= last; k += std::max(1, step)) {
+        std::vector<MapfAgent> subset(scenario.agents.begin(), scenario.agents.begin() + k);
+        BenchmarkRow row;
+        row.name = (newSuboptimality > 1.0f ? "ECBS " : "CBS ") + std::to_string(k) + " agents";
+        row.queries = 1;
+        if (solve(subset, newSuboptimality, timeLimitMs)) {
+            row.solved = 1;
+            row.totalCost = solutionCost;
+        }
+        row.avgUs = row.maxUs = solveMs * 1000.0f;
+        row.expansions = lowLevelExpansions;
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+std::vector<std::vector<Position>> ConflictBasedSearch::getPaths() const
+{
+    std::vector<std::vector<Position>> paths;
+    for (const auto& path : solution) {
+        paths.emplace_back();
+        for (int cell : path)
+            paths.back().push_back(position(cell));
+    }
+    return paths;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Grid.h"
+#include "MapfScenario.h"
+#include "Benchmark.h"
+#include <vector>
+#include <memory>
+#include <chrono>
+
+// Conflict-Based Search for collision-free multi-agent paths on a
+// 4-connected map with unit moves and waits. The high level grows a tree
+// of constraints: each node plans every agent with a space-time A* that
+// respects the constraints on that agent, and the first vertex or edge
+// conflict between two paths splits the node in two, constraining one
+// agent in each child. A child shares all paths with its parent except
+// the one replanned, and reaches its constraints through the parent
+// chain, so a node costs one path plus a pointer per agent.
+//
+// With a suboptimality above 1 this is ECBS: both levels expand from a
+// focal list of entries within that factor of the lower bound, preferring
+// the fewest conflicts, and the sum of costs stays within the factor of
+// the optimum.
+class ConflictBasedSearch
+{
+public:
+	typedef std::vector<int> Path; // cells at t = 0, 1, ...; the agent stays at the last one
+
+private:
+	struct Constraint {
+		int agent = -1; // -1 at the root
+		int from = -1;  // edge constraints only, otherwise -1
+		int cell = -1;
+		int time = 0;
+	};
+
+	struct HighNode {
+		std::shared_ptr<const HighNode> parent;
+		Constraint constraint;
+		std::vector<std::shared_ptr<const Path>> paths;
+		std::vector<int> lowerBounds; // per agent, from its low-level search
+		int cost = 0;
+		int lowerBound = 0;
+		int conflicts = 0;
+	};
+
+	struct Conflict {
+		int first = -1, second = -1;
+		int from = -1, cell = -1; // from set for an edge conflict, seen from the first agent
+		int time = 0;
+	};
+
+	int cols = 0, rows = 0;
+	std::vector<uint8_t> blocked;
+	std::vector<MapfAgent> agents;
+	std::vector<std::vector<int>> goalDistance; // per agent, BFS from the goal
+
+	float suboptimality = 1.0f;
+	std::chrono::steady_clock::time_point deadline;
+	bool timedOut = false;
+	bool solved = false;
+
+	std::vector<Path> solution;
+	int solutionCost = 0;
+	int highLevelNodes = 0;
+	long long lowLevelExpansions = 0;
+	float solveMs = 0.0f;
+
+	int index(Position p) const { return p.x * rows + p.y; }
+	Position position(int cell) const { return { cell / rows, cell % rows }; }
+	void computeDistances();
+	bool planAgent(int agent, const HighNode& node, std::shared_ptr<const Path>& path, int& lowerBound);
+	int countConflicts(const std::vector<std::shared_ptr<const Path>>& paths, Conflict* first) const;
+
+public:
+	void setMap(Grid& grid);
+	void setMap(const MapfScenario& scenario);
+
+	// false when no solution is found within the time limit
+	bool solve(const std::vector<MapfAgent>& newAgents, float newSuboptimality, int timeLimitMs);
+
+	// Solves the first k agents of the scenario for k = step, 2 * step, ... up to maxAgents
+	std::vector<BenchmarkRow> sweep(const MapfScenario& scenario, int step, int maxAgents, float newSuboptimality, int timeLimitMs);
+
+	std::vector<std::vector<Position>> getPaths() const;
+	int getCost() const { return solutionCost; }
+	int getHighLevelNodes() const { return highLevelNodes; }
+	long long getLowLevelExpansions() const { return lowLevelExpansions; }
+	float getSolveMs() const { return solveMs; }
+	bool hasTimedOut() const { return timedOut; }
+	bool isSolved() const { return solved; }
+};
@@ -0,0 +1,340 @@
+#include "ContractionHierarchy.h"
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+typedef std::pair<float, int> HeapEntry; // [distance, cell]
+
+static void heapPush(std::vector<HeapEntry>& heap, float key, int cell)
+{
+    heap.emplace_back(key, cell);
+    std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+}
+
+static HeapEntry heapPop(std::vector<HeapEntry>& heap)
+{
+    std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+    HeapEntry top = heap.back();
+    heap.pop_back();
+    return top;
+}
+
+void ContractionHierarchy::build()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    Position dim = grid.getDimensions();
+    cols = dim.x;
+    rows = dim.y;
+    int cells = cols * rows;
+    std::vector<uint8_t> blocked = grid.getBlockedMask();
+
+    std::vector<std::vector<Edge>> graph(cells);
+    for (int cell = 0; cell < cells; ++cell) {
+        if (blocked[cell])
+            continue;
+        Position pos = position(cell);
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                Position next = pos + Position(dx, dy);
+                if ((dx == 0 && dy == 0) || next.x < 0 || next.x >= cols || next.y < 0 || next.y >= rows)
+                    continue;
+                if (!blocked[index(next)])
+                    graph[cell].push_back({ index(next), (dx != 0 && dy != 0) ? 1.414f : 1.0f, -1 });
+            }
+        }
+    }
+
+    std::vector<uint8_t> contracted(cells, 0);
+    std::vector<int> deletedNeighbours(cells, 0);
+    std::vector<std::vector<Edge>> up(cells);
+    rank.assign(cells, -1);
+    shortcuts = 0;
+
+    // Witness search: bounded Dijkstra that avoids the cell being contracted,
+    // settling fewer cells when only estimating a priority
+    std::vector<float> witness(cells, FLT_MAX);
+    std::vector<int> witnessTouched;
+    std::vector<HeapEntry> heap;
+    auto witnessSearch = [&](int from, int skip, float limit, int maxSettled) {
+        for (int cell : witnessTouched)
+            witness[cell] = FLT_MAX;
+        witnessTouched.clear();
+        heap.clear();
+
+        witness[from] = 0.0f;
+        witnessTouched.push_back(from);
+        heapPush(heap, 0.0f, from);
+        int settled = 0;
+        while (!heap.empty()) {
+            auto [d, cell] = heapPop(heap);
+            if (d > witness[cell])
+                continue;
+            if (d > limit || ++settled > maxSettled)
+                break;
+            for (const auto& edge : graph[cell]) {
+                if (contracted[edge.to] || edge.to == skip)
+                    continue;
+                float dnew = d + edge.cost;
+                if (dnew < witness[edge.to]) {
+                    if (witness[edge.to] == FLT_MAX)
+                        witnessTouched.push_back(edge.to);
+                    witness[edge.to] = dnew;
+                    heapPush(heap, dnew, edge.to);
+                }
+            }
+        }
+    };
+
+    auto addShortcut = [&](int from, int to, float cost, int middle) {
+        for (auto& edge : graph[from]) {
+            if (edge.to == to) {
+                if (cost < edge.cost) {
+                    edge.cost = cost;
+                    edge.middle = middle;
+                    for (auto& back : graph[to])
+                        if (back.to == from) {
+                            back.cost = cost;
+                            back.middle = middle;
+                        }
+                }
+                return false;
+            }
+        }
+        graph[from].push_back({ to, cost, middle });
+        graph[to].push_back({ from, cost, middle });
+        return true;
+    };
+
+    // Shortcuts needed to remove cell; added to the graph unless simulating
+    auto contract = [&](int cell, bool simulate) {
+        std::vector<Edge> neighbours;
+        for (const auto& edge : graph[cell])
+            if (!contracted[edge.to])
+                neighbours.push_back(edge);
+
+        int needed = 0;
+        for (size_t i = 0; i < neighbours.size(); ++i) {
+            float limit = 0.0f;
+            for (size_t j = i + 1; j < neighbours.size(); ++j)
+                limit = std::max(limit, neighbours[i].cost + neighbours[j].cost);
+            if (limit == 0.0f)
+                continue;
+
+            witnessSearch(neighbours[i].to, cell, limit, simulate ? 50 : 100);
+            for (size_t j = i + 1; j < neighbours.size(); ++j) {
+                float cost = neighbours[i].cost + neighbours[j].cost;
+                if (witness[neighbours[j].to] <= cost + 1e-3f)
+                    continue;
+                ++needed;
+                if (!simulate && addShortcut(neighbours[i].to, neighbours[j].to, cost, cell))
+                    ++shortcuts;
+            }
+        }
+        return needed;
+    };
+
+    auto degree = [&](int cell) {
+        int count = 0;
+        for (const auto& edge : graph[cell])
+            if (!contracted[edge.to])
+                ++count;
+        return count;
+    };
+
+    int nextRank = 0;
+    auto finish = [&](int cell) {
+        contract(cell, false);
+        for (const auto& edge : graph[cell]) {
+            up[cell].push_back(edge);
+            ++deletedNeighbours[edge.to];
+
+            // Keep only live edges in the remaining graph
+            auto& back = graph[edge.to];
+            back.erase(std::remove_if(back.begin(), back.end(), [cell](const Edge& e) { return e.to == cell; }), back.end());
+        }
+        graph[cell].clear();
+        contracted[cell] = 1;
+        rank[cell] = nextRank++;
+    };
+
+    // Corridor reduction: contract cells with at most two free neighbours first
+    std::vector<int> corridor;
+    for (int cell = 0; cell < cells; ++cell)
+        if (!blocked[cell] && degree(cell) <= 2)
+            corridor.push_back(cell);
+    while (!corridor.empty()) {
+        int cell = corridor.back();
+        corridor.pop_back();
+        if (contracted[cell] || degree(cell) > 2)
+            continue;
+        finish(cell);
+        for (const auto& edge : up[cell])
+            if (!contracted[edge.to] && degree(edge.to) <= 2)
+                corridor.push_back(edge.to);
+    }
+
+    // Remaining junction and open cells by edge difference, with lazy updates
+    auto priority = [&](int cell) {
+        return contract(cell, true) - degree(cell) + deletedNeighbours[cell];
+    };
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> order;
+    for (int cell = 0; cell < cells; ++cell)
+        if (!blocked[cell] && !contracted[cell])
+            order.emplace(priority(cell), cell);
+
+    while (!order.empty()) {
+        auto [key, cell] = order.top();
+        order.pop();
+        if (contracted[cell])
+            continue;
+
+        int current = priority(cell);
+        if (!order.empty() && current > order.top().first) {
+            order.emplace(current, cell);
+            continue;
+        }
+        finish(cell);
+    }
+
+    firstEdge.assign(cells + 1, 0);
+    upEdges.clear();
+    for (int cell = 0; cell < cells; ++cell) {
+        firstEdge[cell] = static_cast<int>(upEdges.size());
+        upEdges.insert(upEdges.end(), up[cell].begin(), up[cell].end());
+    }
+    firstEdge[cells] = static_cast<int>(upEdges.size());
+
+    for (int dir = 0; dir < 2; ++dir) {
+        distance[dir].assign(cells, FLT_MAX);
+        parent[dir].assign(cells, -1);
+        parentMiddle[dir].assign(cells, -1);
+    }
+    touched.clear();
+
+    builtVersion = grid.getVersion();
+    built = true;
+    buildMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+const ContractionHierarchy::Edge* ContractionHierarchy::findUpEdge(int from, int to) const
+{
+    for (int e = firstEdge[from]; e < firstEdge[from + 1]; ++e)
+        if (upEdges[e].to == to)
+            return &upEdges[e];
+    return nullptr;
+}
+
+// Appends the cells after from up to and including to
+void ContractionHierarchy::unpack(int from, int to, int middle, std::vector<Position>& path) const
+{
+    if (middle == -1) {
+        path.push_back(position(to));
+        return;
+    }
+
+    // The bypassed cell was contracted before both ends, so it owns both halves
+    const Edge* first = findUpEdge(middle, from);
+    const Edge* second = findUpEdge(middle, to);
+    unpack(from, middle, first->middle, path);
+    unpack(middle, to, second->middle, path);
+}
+
+SearchResult ContractionHierarchy::query(Position source, Position target)
+{
+    auto start = std::chrono::steady_clock::now();
+    SearchResult result;
+
+    if (!isValid()) {
+        result.error = Unknown;
+        return result;
+    }
+    if (source == Position(-1, -1)) {
+        result.error = NoSourceNode;
+        return result;
+    }
+    if (target == Position(-1, -1)) {
+        result.error = NoTargetNode;
+        return result;
+    }
+
+    int ends[2] = { index(source), index(target) };
+    std::vector<HeapEntry> heaps[2];
+    for (int dir = 0; dir < 2; ++dir) {
+        distance[dir][ends[dir]] = 0.0f;
+        heapPush(heaps[dir], 0.0f, ends[dir]);
+    }
+    touched.push_back(ends[0]);
+    touched.push_back(ends[1]);
+
+    float best = FLT_MAX;
+    int meet = -1;
+    while (true) {
+        bool active[2] = { !heaps[0].empty() && heaps[0].front().first < best,
+                           !heaps[1].empty() && heaps[1].front().first < best };
+        if (!active[0] && !active[1])
+            break;
+        int dir = (active[0] && (!active[1] || heaps[0].front().first <= heaps[1].front().first)) ? 0 : 1;
+
+        auto [d, cell] = heapPop(heaps[dir]);
+        if (d > distance[dir][cell])
+            continue;
+        ++result.expansions;
+
+        if (distance[1 - dir][cell] != FLT_MAX && d + distance[1 - dir][cell] < best) {
+            best = d + distance[1 - dir][cell];
+            meet = cell;
+        }
+
+        // Stall on demand: a higher cell already reaches this one cheaper
+        bool stalled = false;
+        for (int e = firstEdge[cell]; e < firstEdge[cell + 1] && !stalled; ++e)
+            stalled = distance[dir][upEdges[e].to] + upEdges[e].cost < d;
+        if (stalled)
+            continue;
+
+        for (int e = firstEdge[cell]; e < firstEdge[cell + 1]; ++e) {
+            const Edge& edge = upEdges[e];
+            float dnew = d + edge.cost;
+            if (dnew < distance[dir][edge.to]) {
+                touched.push_back(edge.to);
+                distance[dir][edge.to] = dnew;
+                parent[dir][edge.to] = cell;
+                parentMiddle[dir][edge.to] = edge.middle;
+                heapPush(heaps[dir], dnew, edge.to);
+            }
+        }
+    }
+
+    if (meet == -1) {
+        result.error = NoPath;
+    }
+    else {
+        // Upward chain from the source to the meeting cell, then down to the target
+        std::vector<int> chain;
+        for (int cell = meet; cell != ends[0]; cell = parent[0][cell])
+            chain.push_back(cell);
+        chain.push_back(ends[0]);
+        std::reverse(chain.begin(), chain.end());
+
+        result.waypoints.push_back(source);
+        for (size_t i = 1; i < chain.size(); ++i)
+            unpack(chain[i - 1], chain[i], parentMiddle[0][chain[i]], result.waypoints);
+        for (int cell = meet; cell != ends[1]; cell = parent[1][cell])
+            unpack(cell, parent[1][cell], parentMiddle[1][cell], result.waypoints);
+        result.cost = best;
+    }
+
+    for (int cell : touched) {
+        for (int dir = 0; dir < 2; ++dir) {
+            distance[dir][cell] = FLT_MAX;
+            parent[dir][cell] = -1;
+            parentMiddle[dir][cell] = -1;
+        }
+    }
+    touched.clear();
+
+    result.timeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Grid.h"
+#include "Astar.h"
+#include <vector>
+
+// Contraction hierarchy over the 8-connected free cells of a static Grid.
+// Corridor cells (at most two free neighbours) are contracted first, which
+// collapses corridors into shortcuts between junctions; the remaining cells
+// follow by edge difference. Queries are a bidirectional upward Dijkstra.
+class ContractionHierarchy
+{
+private:
+	struct Edge {
+		int to;
+		float cost;
+		int middle; // contracted cell the shortcut bypasses, -1 for a grid step
+	};
+
+	Grid& grid;
+	int cols = 0, rows = 0;
+	unsigned int builtVersion = 0;
+	bool built = false;
+
+	std::vector<int> rank;
+	std::vector<int> firstEdge; // CSR over upEdges, size cells + 1
+	std::vector<Edge> upEdges;  // only edges towards higher rank
+
+	int shortcuts = 0;
+	float buildMs = 0.0f;
+
+	// query scratch, reset through the touched list
+	std::vector<float> distance[2];
+	std::vector<int> parent[2];
+	std::vector<int> parentMiddle[2];
+	std::vector<int> touched;
+
+	int index(Position p) const { return p.x * rows + p.y; }
+	Position position(int cell) const { return { cell / rows, cell % rows }; }
+	const Edge* findUpEdge(int from, int to) const;
+	void unpack(int from, int to, int middle, std::vector<Position>& path) const;
+
+public:
+	ContractionHierarchy(Grid& _grid) : grid(_grid) {}
+
+	void build();
+	bool isValid() const { return built && builtVersion == grid.getVersion(); }
+
+	SearchResult query(Position source, Position target);
+
+	int getShortcuts() const { return shortcuts; }
+	float getBuildMs() const { return buildMs; }
+	size_t getMemoryBytes() const { return upEdges.size() * sizeof(Edge) + (firstEdge.size() + rank.size()) * sizeof(int); }
+};
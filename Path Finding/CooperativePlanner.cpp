@@ -0,0 +1,266 @@
+#include "CooperativePlanner.h"
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+static const Position moves[9] = { { 0, 0 }, { 0, 1 }, { 1, 0 }, { 0, -1 }, { -1, 0 }, { 1, 1 }, { 1, -1 }, { -1, -1 }, { -1, 1 } };
+
+static float moveCost(Position delta)
+{
+    return (delta.x != 0 && delta.y != 0) ? 1.414f : 1.0f;
+}
+
+void CooperativePlanner::load()
+{
+    Position dim = grid.getDimensions();
+    cols = dim.x;
+    rows = dim.y;
+    blocked = grid.getBlockedMask();
+    goalSearches.clear();
+    loadedVersion = grid.getVersion();
+    loaded = true;
+}
+
+int CooperativePlanner::reservedBy(int t, int cell) const
+{
+    auto it = reservations.find(key(t, cell));
+    return it == reservations.end() ? -1 : it->second;
+}
+
+static float octile(Position a, Position b)
+{
+    int dx = std::abs(a.x - b.x), dy = std::abs(a.y - b.y);
+    return (dx + dy) + (1.414f - 2.0f) * std::min(dx, dy);
+}
+
+static bool later(const std::pair<float, int>& a, const std::pair<float, int>& b)
+{
+    return a.first > b.first;
+}
+
+CooperativePlanner::ReverseSearch& CooperativePlanner::searchTo(int goal, Position origin)
+{
+    auto found = goalSearches.find(goal);
+    if (found != goalSearches.end())
+        return found->second;
+
+    ReverseSearch& search = goalSearches[goal];
+    search.origin = origin;
+    search.distance.assign(static_cast<size_t>(cols) * rows, FLT_MAX);
+    search.closed.assign((static_cast<size_t>(cols) * rows + 63) / 64, 0);
+    search.distance[goal] = 0.0f;
+    search.open.emplace_back(octile(position(goal), origin), goal);
+    return search;
+}
+
+// Resumes the reverse search until the cell is closed or nothing is left
+float CooperativePlanner::distance(ReverseSearch& search, int cell)
+{
+    auto isClosed = [&search](int c) { return (search.closed[c >> 6] >> (c & 63)) & 1u; };
+    while (!isClosed(cell) && !search.open.empty()) {
+        std::pop_heap(search.open.begin(), search.open.end(), later);
+        int current = search.open.back().second;
+        search.open.pop_back();
+        if (isClosed(current))
+            continue;
+        search.closed[current >> 6] |= uint64_t(1) << (current & 63);
+
+        Position pos = position(current);
+        for (int m = 1; m < 9; ++m) {
+            Position next = pos + moves[m];
+            if (next.x < 0 || next.x >= cols || next.y < 0 || next.y >= rows || blocked[index(next)])
+                continue;
+            int nextCell = index(next);
+            float dnew = search.distance[current] + moveCost(moves[m]);
+            if (dnew < search.distance[nextCell]) {
+                search.distance[nextCell] = dnew;
+                search.open.emplace_back(dnew + octile(next, search.origin), nextCell);
+                std::push_heap(search.open.begin(), search.open.end(), later);
+            }
+        }
+    }
+    return isClosed(cell) ? search.distance[cell] : FLT_MAX;
+}
+
+void CooperativePlanner::clearAgents()
+{
+    agents.clear();
+    reservations.clear();
+    time = planStart = firstPriority = 0;
+    collisions = planned = 0;
+    planMs = 0.0f;
+    expansions = 0;
+}
+
+bool CooperativePlanner::addAgent(Position start, Position goal)
+{
+    if (!loaded || loadedVersion != grid.getVersion())
+        load();
+    if (start.x < 0 || start.x >= cols || start.y < 0 || start.y >= rows || blocked[index(start)])
+        return false;
+    if (goal.x < 0 || goal.x >= cols || goal.y < 0 || goal.y >= rows || blocked[index(goal)])
+        return false;
+    for (const auto& agent : agents)
+        if (agent.position == start || agent.goal == goal)
+            return false;
+
+    agents.push_back({ start, goal, start, { start } });
+    return true;
+}
+
+// Distinct starts and distinct goals on free cells
+void CooperativePlanner::randomAgents(int count, unsigned int seed)
+{
+    clearAgents();
+    load();
+    std::vector<int> free;
+    for (int cell = 0; cell < cols * rows; ++cell)
+        if (!blocked[cell])
+            free.push_back(cell);
+
+    std::mt19937 rng(seed);
+    std::vector<int> starts = free, goals = free;
+    std::shuffle(starts.begin(), starts.end(), rng);
+    std::shuffle(goals.begin(), goals.end(), rng);
+    count = std::min(count, static_cast<int>(free.size()));
+    for (int i = 0; i < count; ++i)
+        agents.push_back({ position(starts[i]), position(goals[i]), position(starts[i]), { position(starts[i]) } });
+}
+
+// Space-time A* over [time, time + window]. Waiting costs 1 except on the
+// goal, so an agent that arrives early settles there; the search ends at
+// the first state popped at the window's end.
+bool CooperativePlanner::planAgent(int id)
+{
+    Agent& agent = agents[id];
+    int cells = cols * rows;
+    int goal = index(agent.goal);
+    ReverseSearch& reverse = searchTo(goal, agent.start);
+    int start = index(agent.position);
+
+    // Unreachable cells keep a finite estimate so the agent can still wait
+    auto estimate = [&](int cell) {
+        float d = distance(reverse, cell);
+        return d == FLT_MAX ? static_cast<float>(cells) : d;
+    };
+
+    size_t states = static_cast<size_t>(cells) * (window + 1);
+    if (stamp.size() != states) {
+        g.assign(states, FLT_MAX);
+        parent.assign(states, -1);
+        stamp.assign(states, 0);
+        generation = 0;
+    }
+    ++generation;
+    open.clear();
+
+    auto push = [&](int state, float cost, int from) {
+        g[state] = cost;
+        parent[state] = from;
+        stamp[state] = generation;
+        open.emplace_back(cost + estimate(state % cells), state);
+        std::push_heap(open.begin(), open.end(), later);
+    };
+    auto cost = [&](int state) { return stamp[state] == generation ? g[state] : FLT_MAX; };
+
+    push(start, 0.0f, -1);
+    int last = -1;
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), later);
+        auto [f, state] = open.back();
+        open.pop_back();
+        int depth = state / cells, cell = state % cells;
+        float gcost = cost(state);
+        if (f > gcost + estimate(cell) + 1e-4f)
+            continue;
+        if (depth == window) {
+            last = state;
+            break;
+        }
+        ++expansions;
+
+        Position pos = position(cell);
+        int t = time + depth;
+        for (int m = 0; m < 9; ++m) {
+            Position next = pos + moves[m];
+            if (next.x < 0 || next.x >= cols || next.y < 0 || next.y >= rows || blocked[index(next)])
+                continue;
+            int nextCell = index(next);
+            int holder = reservedBy(t + 1, nextCell);
+            if (holder != -1 && holder != id)
+                continue;
+            // Two agents may not trade places along one edge
+            int other = reservedBy(t, nextCell);
+            if (m != 0 && other != -1 && other != id && reservedBy(t + 1, cell) == other)
+                continue;
+
+            float step = m == 0 ? (cell == goal ? 0.0f : 1.0f) : moveCost(moves[m]);
+            int nextState = (depth + 1) * cells + nextCell;
+            if (gcost + step < cost(nextState))
+                push(nextState, gcost + step, state);
+        }
+    }
+
+    agent.plan.assign(window + 1, agent.position);
+    if (last == -1)
+        return false;
+    for (int state = last; state != -1; state = parent[state])
+        agent.plan[state / cells] = position(state % cells);
+    return true;
+}
+
+void CooperativePlanner::planAll()
+{
+    if (!loaded || loadedVersion != grid.getVersion())
+        load();
+    auto start = std::chrono::steady_clock::now();
+
+    reservations.clear();
+    for (int id = 0; id < static_cast<int>(agents.size()); ++id)
+        reservations[key(time, index(agents[id].position))] = id;
+
+    planned = 0;
+    expansions = 0;
+    int count = static_cast<int>(agents.size());
+    for (int i = 0; i < count; ++i) {
+        int id = (firstPriority + i) % count;
+        if (planAgent(id))
+            ++planned;
+        for (int depth = 1; depth <= window; ++depth)
+            reservations.emplace(key(time + depth, index(agents[id].plan[depth])), id);
+    }
+    firstPriority = count > 0 ? (firstPriority + 1) % count : 0;
+    planStart = time;
+    planMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void CooperativePlanner::step()
+{
+    if (agents.empty())
+        return;
+    if (time - planStart >= window / 2 || loadedVersion != grid.getVersion())
+        planAll();
+
+    ++time;
+    std::unordered_map<int, int> occupied;
+    for (auto& agent : agents) {
+        agent.position = agent.plan[std::min<size_t>(time - planStart, agent.plan.size() - 1)];
+        if (occupied[index(agent.position)]++ > 0)
+            ++collisions;
+    }
+}
+
+void CooperativePlanner::setWindow(int newWindow)
+{
+    newWindow = std::max(2, newWindow);
+    if (newWindow == window)
+        return;
+    window = newWindow;
+    if (!agents.empty())
+        planAll();
+}
+
+int CooperativePlanner::getArrived() const
+{
+    return static_cast<int>(std::count_if(agents.begin(), agents.end(), [](const Agent& agent) { return agent.position == agent.goal; }));
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Grid.h"
+#include "Astar.h"
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <cstdint>
+
+// Windowed hierarchical cooperative A* (WHCA*) for many agents on one Grid.
+// Agents are planned one after another in (x, y, t) for `window` steps;
+// each plan is written into a hashed space-time reservation table that
+// later agents must avoid, including swaps along an edge. The heuristic
+// is the true distance to the agent's goal, from a reverse A* per goal
+// that is resumed only as far as the cells asked about (RRA*). Agents
+// replan every window / 2 steps with rotating priorities, so no agent is
+// always planned last.
+class CooperativePlanner
+{
+public:
+	struct Agent {
+		Position start, goal;
+		Position position;
+		std::vector<Position> plan; // positions at time planStart, planStart + 1, ...
+	};
+
+private:
+	Grid& grid;
+	int cols = 0, rows = 0;
+	unsigned int loadedVersion = 0;
+	bool loaded = false;
+
+	std::vector<uint8_t> blocked;
+	std::vector<Agent> agents;
+	int window = 16;
+	int time = 0;
+	int planStart = 0;
+	int firstPriority = 0;
+
+	std::unordered_map<uint64_t, int> reservations; // time << 32 | cell -> agent
+	typedef std::pair<float, int> Entry; // [f, state]
+
+	// Reverse A* from a goal towards the first agent's start; closed cells hold exact distances
+	struct ReverseSearch {
+		Position origin;
+		std::vector<float> distance;
+		std::vector<uint64_t> closed;
+		std::vector<Entry> open;
+	};
+	std::unordered_map<int, ReverseSearch> goalSearches; // by goal cell
+
+	// space-time search scratch over [depth * cells + cell], stamped per search
+	std::vector<float> g;
+	std::vector<int> parent;
+	std::vector<unsigned int> stamp;
+	unsigned int generation = 0;
+	std::vector<Entry> open;
+
+	float planMs = 0.0f;
+	int planned = 0;
+	long long expansions = 0;
+	int collisions = 0;
+
+	int index(Position p) const { return p.x * rows + p.y; }
+	Position position(int cell) const { return { cell / rows, cell % rows }; }
+	static uint64_t key(int t, int cell) { return static_cast<uint64_t>(t) << 32 | static_cast<uint32_t>(cell); }
+	int reservedBy(int t, int cell) const;
+
+	void load();
+	ReverseSearch& searchTo(int goal, Position origin);
+	float distance(ReverseSearch& search, int cell);
+	bool planAgent(int id);
+
+public:
+	CooperativePlanner(Grid& _grid) : grid(_grid) {}
+
+	void clearAgents();
+	bool addAgent(Position start, Position goal); // false on blocked or already claimed cells
+	void randomAgents(int count, unsigned int seed);
+
+	void planAll(); // fresh reservations from the current positions, one window ahead
+	void step();    // every agent moves one step; replans halfway through the window
+
+	void setWindow(int newWindow); // replans at once, since plans hold one window of steps
+	int getWindow() const { return window; }
+
+	const std::vector<Agent>& getAgents() const { return agents; }
+	int getTime() const { return time; }
+	int getArrived() const;
+	int getCollisions() const { return collisions; }
+	int getPlanned() const { return planned; }
+	float getPlanMs() const { return planMs; }
+	long long getExpansions() const { return expansions; }
+	float getAgentsPerSecond() const { return planMs > 0.0f ? agents.size() * 1000.0f / planMs : 0.0f; }
+};
@@ -0,0 +1,178 @@
+#include "FirstMoveTable.h"
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+#include <queue>
+#include <thread>
+#include <bit>
+
+static const Position moves[8] = { { 0, 1 }, { 1, 1 }, { 1, 0 }, { 1, -1 }, { 0, -1 }, { -1, -1 }, { -1, 0 }, { -1, 1 } };
+
+// Interleaves the bits of x and y
+static uint32_t morton(uint32_t x, uint32_t y)
+{
+    uint32_t code = 0;
+    for (int bit = 0; bit < 16; ++bit)
+        code |= ((x >> bit) & 1u) << (2 * bit) | ((y >> bit) & 1u) << (2 * bit + 1);
+    return code;
+}
+
+// Worker loop: takes sources off the shared counter until none are left
+void FirstMoveTable::buildRows(std::atomic<int>& nextSource, const std::vector<uint8_t>& blocked, const std::vector<int>& byRank, std::vector<std::vector<uint32_t>>& rowRuns) const
+{
+    int cells = cols * rows;
+    std::vector<float> distance(cells);
+    std::vector<uint16_t> optimal(cells); // bit per optimal first move, NoMove bit when unreachable
+    typedef std::pair<float, int> Entry; // [distance, cell]
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+    for (int source = nextSource++; source < cells; source = nextSource++) {
+        if (blocked[source])
+            continue;
+
+        // Dijkstra that carries every optimal first move of each cell
+        std::fill(distance.begin(), distance.end(), FLT_MAX);
+        std::fill(optimal.begin(), optimal.end(), static_cast<uint16_t>(1u << NoMove));
+        distance[source] = 0.0f;
+        open.emplace(0.0f, source);
+        while (!open.empty()) {
+            auto [d, cell] = open.top();
+            open.pop();
+            if (d > distance[cell])
+                continue;
+
+            Position pos = position(cell);
+            for (uint8_t move = 0; move < 8; ++move) {
+                Position next = pos + moves[move];
+                if (next.x < 0 || next.x >= cols || next.y < 0 || next.y >= rows || blocked[index(next)])
+                    continue;
+                int nextCell = index(next);
+                float dnew = d + ((move & 1) ? 1.414f : 1.0f);
+                uint16_t first = (cell == source) ? static_cast<uint16_t>(1u << move) : optimal[cell];
+                if (dnew < distance[nextCell] - 1e-4f) {
+                    distance[nextCell] = dnew;
+                    optimal[nextCell] = first;
+                    open.emplace(dnew, nextCell);
+                }
+                else if (dnew < distance[nextCell] + 1e-4f) {
+                    optimal[nextCell] |= first;
+                }
+            }
+        }
+
+        // Greedy runs: keep a run going while some move stays optimal for all of its targets.
+        // Blocked targets and the source itself are never asked for, so they never break a run.
+        auto& row = rowRuns[source];
+        uint16_t common = 0;
+        for (int rank = 0; rank < cells; ++rank) {
+            int target = byRank[rank];
+            if (blocked[target] || target == source)
+                continue;
+            if (common & optimal[target]) {
+                common &= optimal[target];
+                continue;
+            }
+            if (!row.empty())
+                row.back() |= std::countr_zero(common);
+            row.push_back(row.empty() ? 0u : static_cast<uint32_t>(rank) << 4);
+            common = optimal[target];
+        }
+        if (!row.empty())
+            row.back() |= std::countr_zero(common);
+    }
+}
+
+void FirstMoveTable::build()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    Position dim = grid.getDimensions();
+    cols = dim.x;
+    rows = dim.y;
+    int cells = cols * rows;
+    std::vector<uint8_t> blocked = grid.getBlockedMask();
+
+    std::vector<int> byRank(cells);
+    std::iota(byRank.begin(), byRank.end(), 0);
+    std::sort(byRank.begin(), byRank.end(), [&](int a, int b) {
+        return morton(a / rows, a % rows) < morton(b / rows, b % rows);
+    });
+    mortonRank.assign(cells, 0);
+    for (int rank = 0; rank < cells; ++rank)
+        mortonRank[byRank[rank]] = rank;
+
+    std::vector<std::vector<uint32_t>> rowRuns(cells);
+    std::atomic<int> nextSource = 0;
+    threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i)
+        workers.emplace_back([&]() { buildRows(nextSource, blocked, byRank, rowRuns); });
+    for (auto& worker : workers)
+        worker.join();
+
+    firstRun.assign(cells + 1, 0);
+    runs.clear();
+    for (int cell = 0; cell < cells; ++cell) {
+        firstRun[cell] = static_cast<uint32_t>(runs.size());
+        runs.insert(runs.end(), rowRuns[cell].begin(), rowRuns[cell].end());
+    }
+    firstRun[cells] = static_cast<uint32_t>(runs.size());
+
+    lookupNs = 0.0;
+    lookups = 0;
+    builtVersion = grid.getVersion();
+    built = true;
+    buildMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Last run starting at or before the target's rank
+uint8_t FirstMoveTable::firstMove(int source, int target) const
+{
+    auto first = runs.begin() + firstRun[source];
+    auto last = runs.begin() + firstRun[source + 1];
+    if (first == last)
+        return NoMove;
+    auto run = std::upper_bound(first, last, mortonRank[target] << 4 | 15u);
+    return static_cast<uint8_t>(*(run - 1) & 15u);
+}
+
+SearchResult FirstMoveTable::query(Position source, Position target)
+{
+    auto start = std::chrono::steady_clock::now();
+    SearchResult result;
+
+    if (!isValid()) {
+        result.error = Unknown;
+        return result;
+    }
+    if (source == Position(-1, -1)) {
+        result.error = NoSourceNode;
+        return result;
+    }
+    if (target == Position(-1, -1)) {
+        result.error = NoTargetNode;
+        return result;
+    }
+
+    int goal = index(target);
+    Position pos = source;
+    result.waypoints.push_back(pos);
+    while (pos != target) {
+        uint8_t move = firstMove(index(pos), goal);
+        ++result.expansions;
+        if (move == NoMove || result.expansions > cols * rows) {
+            result.error = NoPath;
+            result.waypoints.clear();
+            break;
+        }
+        pos += moves[move];
+        result.cost += (move & 1) ? 1.414f : 1.0f;
+        result.waypoints.push_back(pos);
+    }
+
+    float elapsedMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    lookupNs += elapsedMs * 1e6;
+    lookups += result.expansions;
+    result.timeMs = elapsedMs;
+    return result;
+}
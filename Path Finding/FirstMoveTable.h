@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Grid.h"
+#include "Astar.h"
+#include <vector>
+#include <cstdint>
+#include <atomic>
+
+// Compressed path database for a static Grid: for every free source cell,
+// the first step of an optimal path towards every other cell. Targets are
+// laid out in Morton order so nearby cells, which tend to share a first
+// move, form long runs; each source row is stored run-length encoded.
+// Queries follow first moves cell by cell without any open list.
+class FirstMoveTable
+{
+private:
+	static constexpr uint8_t NoMove = 8; // target unreachable from the source
+
+	Grid& grid;
+	int cols = 0, rows = 0;
+	unsigned int builtVersion = 0;
+	bool built = false;
+
+	std::vector<uint32_t> mortonRank; // per cell, its index in Morton order
+	std::vector<uint32_t> firstRun;   // per cell, offset into runs, size cells + 1
+	std::vector<uint32_t> runs;       // start rank << 4 | move
+
+	float buildMs = 0.0f;
+	int threads = 0;
+	double lookupNs = 0.0;
+	long long lookups = 0;
+
+	int index(Position p) const { return p.x * rows + p.y; }
+	Position position(int cell) const { return { cell / rows, cell % rows }; }
+	void buildRows(std::atomic<int>& nextSource, const std::vector<uint8_t>& blocked, const std::vector<int>& byRank, std::vector<std::vector<uint32_t>>& rowRuns) const;
+	uint8_t firstMove(int source, int target) const;
+
+public:
+	FirstMoveTable(Grid& _grid) : grid(_grid) {}
+
+	void build(); // one Dijkstra per free cell, spread over the hardware threads
+	bool isValid() const { return built && builtVersion == grid.getVersion(); }
+
+	SearchResult query(Position source, Position target);
+
+	float getBuildMs() const { return buildMs; }
+	int getThreads() const { return threads; }
+	size_t getRuns() const { return runs.size(); }
+	size_t getMemoryBytes() const { return (runs.size() + firstRun.size() + mortonRank.size()) * sizeof(uint32_t); }
+	size_t getUncompressedBytes() const { return static_cast<size_t>(cols) * rows * cols * rows / 2; } // 4 bits per move
+	double getLookupNs() const { return lookups > 0 ? lookupNs / lookups : 0.0; }
+};
@@ -0,0 +1,191 @@
+#include "FlowField.h"
+#include <chrono>
+
+// Larger batches of edits are cheaper to handle with a full recompute
+static const size_t maxIncrementalEdits = 256;
+
+static float moveCost(Position delta)
+{
+    return (delta.x != 0 && delta.y != 0) ? 1.414f : 1.0f;
+}
+
+// Offers every free neighbour a path through cell
+void FlowField::relax(int cell, Queue& open)
+{
+    Position pos = position(cell);
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            Position next = pos + Position(dx, dy);
+            if ((dx == 0 && dy == 0) || !isFree(next))
+                continue;
+            int nextCell = index(next);
+            float dnew = distance[cell] + moveCost({ dx, dy });
+            if (dnew < distance[nextCell]) {
+                distance[nextCell] = dnew;
+                step[nextCell] = Position(-dx, -dy);
+                open.emplace(dnew, nextCell);
+            }
+        }
+    }
+}
+
+void FlowField::propagate(Queue& open)
+{
+    while (!open.empty()) {
+        auto [d, cell] = open.top();
+        open.pop();
+        if (d > distance[cell])
+            continue;
+        ++updatedCells;
+        relax(cell, open);
+    }
+}
+
+void FlowField::compute(Position goal)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    Position dim = grid.getDimensions();
+    cols = dim.x;
+    rows = dim.y;
+    blocked = grid.getBlockedMask();
+    distance.assign(cols * rows, FLT_MAX);
+    step.assign(cols * rows, Position(0, 0));
+    target = goal;
+    updatedCells = 0;
+
+    Queue open;
+    distance[index(goal)] = 0.0f;
+    open.emplace(0.0f, index(goal));
+    propagate(open);
+
+    builtVersion = grid.getVersion();
+    built = true;
+    buildMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Only cells whose steps led through the new wall lose their distance;
+// they are refilled from the untouched cells around them
+void FlowField::blockCell(Position wall)
+{
+    blocked[index(wall)] = 1;
+    std::vector<int> affected = { index(wall) };
+    distance[index(wall)] = FLT_MAX;
+    step[index(wall)] = Position(0, 0);
+
+    for (size_t i = 0; i < affected.size(); ++i) {
+        Position pos = position(affected[i]);
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                Position next = pos + Position(dx, dy);
+                if ((dx == 0 && dy == 0) || !isFree(next))
+                    continue;
+                int nextCell = index(next);
+                if (distance[nextCell] != FLT_MAX && next + step[nextCell] == pos) {
+                    distance[nextCell] = FLT_MAX;
+                    step[nextCell] = Position(0, 0);
+                    affected.push_back(nextCell);
+                }
+            }
+        }
+    }
+
+    Queue open;
+    for (size_t i = 1; i < affected.size(); ++i) {
+        int cell = affected[i];
+        Position pos = position(cell);
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                Position next = pos + Position(dx, dy);
+                if ((dx == 0 && dy == 0) || !isFree(next) || distance[index(next)] == FLT_MAX)
+                    continue;
+                float dnew = distance[index(next)] + moveCost({ dx, dy });
+                if (dnew < distance[cell]) {
+                    distance[cell] = dnew;
+                    step[cell] = Position(dx, dy);
+                }
+            }
+        }
+        if (distance[cell] != FLT_MAX)
+            open.emplace(distance[cell], cell);
+    }
+    propagate(open);
+}
+
+// A freed cell can only shorten paths, so it is seeded from its neighbours and spread outwards
+void FlowField::freeCell(Position cell)
+{
+    blocked[index(cell)] = 0;
+    Queue open;
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            Position next = cell + Position(dx, dy);
+            if ((dx == 0 && dy == 0) || !isFree(next) || distance[index(next)] == FLT_MAX)
+                continue;
+            open.emplace(distance[index(next)], index(next));
+        }
+    }
+    propagate(open);
+}
+
+void FlowField::update()
+{
+    Position goal = grid.getTargetPos();
+    if (goal == Position(-1, -1)) {
+        built = false;
+        target = goal;
+        return;
+    }
+    if (isValid())
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Position> cells;
+    if (!built || goal != target || grid.getDimensions() != Position(cols, rows) ||
+        !grid.getEditsSince(builtVersion, cells) || cells.size() > maxIncrementalEdits) {
+        compute(goal);
+    }
+    else {
+        updatedCells = 0;
+        for (const auto& cell : cells) {
+            bool wall = grid.isBlocked(cell);
+            if (wall == static_cast<bool>(blocked[index(cell)]))
+                continue;
+            if (wall)
+                blockCell(cell);
+            else
+                freeCell(cell);
+        }
+        builtVersion = grid.getVersion();
+    }
+    updateUs = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+SearchResult FlowField::path(Position source) const
+{
+    auto start = std::chrono::steady_clock::now();
+    SearchResult result;
+
+    if (!isValid()) {
+        result.error = Unknown;
+        return result;
+    }
+    if (source == Position(-1, -1)) {
+        result.error = NoSourceNode;
+        return result;
+    }
+    if (distance[index(source)] == FLT_MAX) {
+        result.error = NoPath;
+        return result;
+    }
+
+    for (Position pos = source; ; pos = nextStep(pos)) {
+        result.waypoints.push_back(pos);
+        if (pos == target)
+            break;
+        ++result.expansions;
+    }
+    result.cost = distance[index(source)];
+    result.timeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Grid.h"
+#include "Astar.h"
+#include <vector>
+#include <queue>
+
+// Dijkstra map towards the grid's target: one reverse search stores, for
+// every free cell, its distance to the target and the step to take next,
+// so any number of agents can move without searching. Wall edits are
+// repaired locally from the grid's edit log.
+class FlowField
+{
+private:
+	Grid& grid;
+	int cols = 0, rows = 0;
+	unsigned int builtVersion = 0;
+	bool built = false;
+	Position target = { -1, -1 };
+
+	std::vector<uint8_t> blocked;
+	std::vector<float> distance; // per cell, FLT_MAX if the target can't be reached
+	std::vector<Position> step;  // per cell, {0, 0} at the target and unreachable cells
+
+	float buildMs = 0.0f;
+	float updateUs = 0.0f;
+	int updatedCells = 0;
+
+	typedef std::pair<float, int> Entry; // [distance, cell]
+	typedef std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> Queue;
+
+	int index(Position p) const { return p.x * rows + p.y; }
+	Position position(int cell) const { return { cell / rows, cell % rows }; }
+	bool isFree(Position p) const { return p.x >= 0 && p.x < cols && p.y >= 0 && p.y < rows && !blocked[index(p)]; }
+	void relax(int cell, Queue& open);
+	void propagate(Queue& open);
+	void blockCell(Position cell);
+	void freeCell(Position cell);
+
+public:
+	FlowField(Grid& _grid) : grid(_grid) {}
+
+	void compute(Position goal);
+	void update(); // follows the target and wall edits, recomputing fully only when it has to
+	bool isValid() const { return built && builtVersion == grid.getVersion() && target == grid.getTargetPos(); }
+
+	Position nextStep(Position from) const { return distance[index(from)] == FLT_MAX ? Position(-1, -1) : from + step[index(from)]; }
+	SearchResult path(Position source) const;
+
+	const std::vector<float>& getDistances() const { return distance; }
+	const std::vector<Position>& getSteps() const { return step; }
+	float getBuildMs() const { return buildMs; }
+	float getUpdateUs() const { return updateUs; }
+	int getUpdatedCells() const { return updatedCells; }
+};
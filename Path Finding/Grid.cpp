@@ -1,10 +1,15 @@
 #include "Grid.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
 
 Grid::Grid(sf::RenderWindow& Window, sf::RectangleShape& background) : window(&Window), size(50.f), drawable_area(&background) {
     reinitialize(size, guiMarginRight);
 }
 
 Position Grid::getDimensions() {
+    if (fixedDimensions.x > 0 && fixedDimensions.y > 0)
+        return fixedDimensions;
     int cols = static_cast<int>(drawable_area->getSize().x / size);
     int rows = static_cast<int>(drawable_area->getSize().y / size);
     return { cols, rows };
@@ -24,6 +29,11 @@ void Grid::initialize() {
 }
 
 void Grid::reinitialize(float newSize, float newMarginRight) {
+    TraceSpan span("Grid::reinitialize");
+    ++version;
+    overlayLoaded = false;
+    edits.clear();
+    editBase = version;
     size = newSize;
     guiMarginRight = newMarginRight;
     Node::guiMarginRight = newMarginRight;
@@ -44,6 +54,11 @@ void Grid::reinitialize(float newSize, float newMarginRight) {
     nodes.clear();
     nodes.resize(cols, std::vector<Node>(rows));
 
+    if (sourcePos.x >= cols || sourcePos.y >= rows)
+        sourcePos = { -1, -1 };
+    if (targetPos.x >= cols || targetPos.y >= rows)
+        targetPos = { -1, -1 };
+
     for (const auto& node : tempNodes) {
         Position pos = node.getWorldPosition();
         if (pos.x >= 0 && pos.x < cols && pos.y >= 0 && pos.y < rows) {
@@ -51,6 +66,9 @@ void Grid::reinitialize(float newSize, float newMarginRight) {
         }
     }
 
+    labelComponents();
+    buildPyramid();
+
     for (int x = 0; x < cols; ++x) {
         for (int y = 0; y < rows; ++y) {
             Position gridPos(x, y);
@@ -63,75 +81,583 @@ void Grid::reinitialize(float newSize, float newMarginRight) {
     }
 }
 
+// Only the cells inside the window's view are submitted; when they would be
+// smaller than lodPixels on screen, blocks of cells are drawn instead
 void Grid::draw() {
-    for (auto& col : nodes)
-        for (auto& node : col)
-            node.draw();
+    TraceSpan span("Grid::draw");
+    const sf::View& view = window->getView();
+    Pos corner = view.getCenter() - view.getSize() / 2.0f;
+    int x0 = std::clamp(static_cast<int>(std::floor(corner.x / size)), 0, cols);
+    int y0 = std::clamp(static_cast<int>(std::floor(corner.y / size)), 0, rows);
+    int x1 = std::clamp(static_cast<int>(std::ceil((corner.x + view.getSize().x) / size)), 0, cols);
+    int y1 = std::clamp(static_cast<int>(std::ceil((corner.y + view.getSize().y) / size)), 0, rows);
+
+    float pixelsPerCell = size * window->getSize().x * view.getViewport().width / view.getSize().x;
+    if (levelOfDetail && pixelsPerCell < lodPixels && !blockedPyramid.empty()) {
+        int level = 0;
+        while (level + 1 < static_cast<int>(blockedPyramid.size()) && (2 << level) * pixelsPerCell < lodPixels)
+            ++level;
+        drawBlocks(level, x0, y0, x1, y1);
+        return;
+    }
+
+    lodBlock = 0;
+    drawnQuads = (x1 - x0) * (y1 - y0);
+    for (int x = x0; x < x1; ++x)
+        for (int y = y0; y < y1; ++y)
+            nodes[x][y].draw();
 }
 
-std::optional<Node> Grid::on_mouse_hover(Pos mousePos) {
-    for (auto& col : nodes) {
-        for (auto& node : col) {
-            if (node.contains(mousePos))
-                return node;
+// One quad per block with anything blocked, shaded by how much is, over a
+// white backdrop; the source and target stay visible as whole blocks
+void Grid::drawBlocks(int level, int x0, int y0, int x1, int y1) {
+    int block = 2 << level;
+    int blockRows = (rows + block - 1) / block;
+    const std::vector<int>& counts = blockedPyramid[level];
+    float side = block * size;
+
+    sf::VertexArray quads(sf::Quads);
+    auto addQuad = [&](Pos corner, Pos extent, sf::Color color) {
+        quads.append(sf::Vertex(corner, color));
+        quads.append(sf::Vertex(corner + Pos(extent.x, 0.0f), color));
+        quads.append(sf::Vertex(corner + extent, color));
+        quads.append(sf::Vertex(corner + Pos(0.0f, extent.y), color));
+    };
+
+    addQuad(Pos(x0 * size, y0 * size), Pos((x1 - x0) * size, (y1 - y0) * size), sf::Color::White);
+    for (int bx = x0 / block; bx * block < x1; ++bx) {
+        for (int by = y0 / block; by * block < y1; ++by) {
+            int blocked = counts[bx * blockRows + by];
+            if (blocked == 0)
+                continue;
+            int cells = (std::min(cols, (bx + 1) * block) - bx * block) * (std::min(rows, (by + 1) * block) - by * block);
+            float t = static_cast<float>(blocked) / cells;
+            sf::Uint8 shade = static_cast<sf::Uint8>(255 - t * (255 - 156));
+            addQuad(Pos(bx * side, by * side), Pos(side, side), sf::Color(shade, shade, shade));
         }
     }
-    return std::nullopt;
+    if (sourcePos != Position(-1, -1))
+        addQuad(Pos((sourcePos.x / block) * side, (sourcePos.y / block) * side), Pos(side, side), sf::Color::Green);
+    if (targetPos != Position(-1, -1))
+        addQuad(Pos((targetPos.x / block) * side, (targetPos.y / block) * side), Pos(side, side), sf::Color::Red);
+
+    lodBlock = block;
+    drawnQuads = static_cast<int>(quads.getVertexCount() / 4);
+    window->draw(quads);
+}
+
+void Grid::buildPyramid() {
+    blockedPyramid.clear();
+    for (int block = 2; block / 2 < std::max(cols, rows); block *= 2) {
+        int blockRows = (rows + block - 1) / block;
+        blockedPyramid.emplace_back(static_cast<size_t>((cols + block - 1) / block) * blockRows, 0);
+    }
+    for (int x = 0; x < cols; ++x)
+        for (int y = 0; y < rows; ++y)
+            if (nodes[x][y].getState() == NodeState::Blocked)
+                updatePyramid({ x, y }, 1);
+}
+
+void Grid::updatePyramid(Position cell, int delta) {
+    for (size_t level = 0; level < blockedPyramid.size(); ++level) {
+        int block = 2 << level;
+        int blockRows = (rows + block - 1) / block;
+        blockedPyramid[level][(cell.x / block) * blockRows + cell.y / block] += delta;
+    }
+}
+
+void Grid::drawPath(const std::vector<Position>& waypoints) {
+    std::vector<Pos> points;
+    points.reserve(waypoints.size());
+    for (const auto& waypoint : waypoints)
+        points.emplace_back(waypoint.x + 0.5f, waypoint.y + 0.5f);
+    drawPath(points);
+}
+
+// Points are in cell units
+void Grid::drawPath(const std::vector<Pos>& points) {
+    sf::VertexArray lines(sf::LineStrip, points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        lines[i].position = points[i] * size;
+        lines[i].color = sf::Color::Red;
+    }
+    window->draw(lines);
+}
+
+// Blue for t = 0 through to red for t = 1
+static sf::Color heatColor(float t) {
+    return sf::Color(static_cast<sf::Uint8>(255 * t), 64, static_cast<sf::Uint8>(255 * (1.0f - t)), 140);
+}
+
+// Blue for the smallest value through to red for the largest
+void Grid::drawHeatmap(const std::vector<float>& values) {
+    if (values.size() != static_cast<size_t>(cols) * rows)
+        return;
+
+    float maxValue = 0.0f;
+    for (float value : values)
+        if (value != FLT_MAX)
+            maxValue = std::max(maxValue, value);
+    if (maxValue <= 0.0f)
+        maxValue = 1.0f;
+
+    sf::VertexArray quads(sf::Quads);
+    for (int x = 0; x < cols; ++x) {
+        for (int y = 0; y < rows; ++y) {
+            float value = values[x * rows + y];
+            if (value == FLT_MAX)
+                continue;
+            sf::Color color = heatColor(value / maxValue);
+            Pos corner(x * size, y * size);
+            quads.append(sf::Vertex(corner, color));
+            quads.append(sf::Vertex(corner + Pos(size, 0.0f), color));
+            quads.append(sf::Vertex(corner + Pos(size, size), color));
+            quads.append(sf::Vertex(corner + Pos(0.0f, size), color));
+        }
+    }
+    window->draw(quads);
+}
+
+// A square in the middle of each cell, half the cell wide
+void Grid::drawMarkers(const std::vector<Position>& cells, sf::Color color) {
+    sf::VertexArray quads(sf::Quads);
+    for (const auto& cell : cells) {
+        Pos corner((cell.x + 0.25f) * size, (cell.y + 0.25f) * size);
+        float side = size * 0.5f;
+        quads.append(sf::Vertex(corner, color));
+        quads.append(sf::Vertex(corner + Pos(side, 0.0f), color));
+        quads.append(sf::Vertex(corner + Pos(side, side), color));
+        quads.append(sf::Vertex(corner + Pos(0.0f, side), color));
+    }
+    window->draw(quads);
+}
+
+// Colours like drawHeatmap, but over the full range of the values (which may
+// be negative) and written once into a texture; drawing is then one quad
+void Grid::setOverlay(const std::vector<float>& values) {
+    overlayLoaded = false;
+    if (values.size() != static_cast<size_t>(cols) * rows)
+        return;
+
+    float low = FLT_MAX, high = -FLT_MAX;
+    for (float value : values) {
+        if (value == FLT_MAX)
+            continue;
+        low = std::min(low, value);
+        high = std::max(high, value);
+    }
+    float range = high > low ? high - low : 1.0f;
+
+    overlayPixels.assign(static_cast<size_t>(cols) * rows * 4, 0);
+    for (int x = 0; x < cols; ++x) {
+        for (int y = 0; y < rows; ++y) {
+            float value = values[x * rows + y];
+            if (value == FLT_MAX)
+                continue;
+            sf::Color color = heatColor((value - low) / range);
+            sf::Uint8* texel = &overlayPixels[(static_cast<size_t>(y) * cols + x) * 4];
+            texel[0] = color.r;
+            texel[1] = color.g;
+            texel[2] = color.b;
+            texel[3] = color.a;
+        }
+    }
+
+    if (overlayTexture.getSize() != sf::Vector2u(cols, rows) && !overlayTexture.create(cols, rows))
+        return;
+    overlayTexture.update(overlayPixels.data());
+    overlayLoaded = true;
+}
+
+void Grid::drawOverlay() {
+    if (!overlayLoaded)
+        return;
+    sf::Sprite sprite(overlayTexture);
+    sprite.setScale(size, size);
+    window->draw(sprite);
+}
+
+// A short line from each cell centre towards its step, with a dot at the tip
+void Grid::drawArrows(const std::vector<Position>& steps) {
+    if (steps.size() != static_cast<size_t>(cols) * rows)
+        return;
+
+    sf::VertexArray lines(sf::Lines);
+    sf::VertexArray tips(sf::Points);
+    for (int x = 0; x < cols; ++x) {
+        for (int y = 0; y < rows; ++y) {
+            Position step = steps[x * rows + y];
+            if (step == Position(0, 0))
+                continue;
+            Pos centre((x + 0.5f) * size, (y + 0.5f) * size);
+            Pos tip = centre + Pos(static_cast<float>(step.x), static_cast<float>(step.y)) * (size * 0.4f);
+            lines.append(sf::Vertex(centre, sf::Color::Black));
+            lines.append(sf::Vertex(tip, sf::Color::Black));
+            tips.append(sf::Vertex(tip, sf::Color::Red));
+        }
+    }
+    window->draw(lines);
+    window->draw(tips);
+}
+
+// Integer grid traversal between two cell centres; every cell the segment
+// touches must be free. Passing exactly through a corner is blocked only by a
+// diagonal wall, i.e. when both side cells are blocked.
+bool Grid::lineOfSight(Position from, Position to) const {
+    int dx = std::abs(to.x - from.x);
+    int dy = std::abs(to.y - from.y);
+    int sx = (to.x > from.x) ? 1 : -1;
+    int sy = (to.y > from.y) ? 1 : -1;
+    int error = dx - dy;
+    dx *= 2;
+    dy *= 2;
+
+    Position p = from;
+    while (p != to) {
+        if (error > 0) {
+            p.x += sx;
+            error -= dy;
+        }
+        else if (error < 0) {
+            p.y += sy;
+            error += dx;
+        }
+        else {
+            // Through a corner, like a diagonal step of the grid search
+            p.x += sx;
+            p.y += sy;
+            error += dx - dy;
+        }
+
+        if (isBlocked(p))
+            return false;
+    }
+    return true;
+}
+
+std::vector<uint8_t> Grid::getBlockedMask() const {
+    std::vector<uint8_t> mask(static_cast<size_t>(cols) * rows, 0);
+    for (int x = 0; x < cols; ++x)
+        for (int y = 0; y < rows; ++y)
+            mask[static_cast<size_t>(x) * rows + y] = isBlocked({ x, y }) ? 1 : 0;
+    return mask;
+}
+
+// FNV-1a over the dimensions and the blocked cells
+uint64_t Grid::contentHash() const {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+
+    mix(static_cast<uint64_t>(cols));
+    mix(static_cast<uint64_t>(rows));
+    for (uint8_t blocked : getBlockedMask())
+        mix(blocked);
+    return hash;
+}
+
+std::optional<Node> Grid::on_mouse_hover(Pos mousePos) {
+    auto cell = cellAt(mousePos);
+    if (!cell)
+        return std::nullopt;
+    return nodes[cell->x][cell->y];
+}
+
+// Cells sit at gridPos * size, so the cell under a point is a division away
+std::optional<Position> Grid::cellAt(Pos point) const {
+    if (point.x < 0.0f || point.y < 0.0f)
+        return std::nullopt;
+    Position cell(static_cast<int>(point.x / size), static_cast<int>(point.y / size));
+    if (cell.x >= cols || cell.y >= rows)
+        return std::nullopt;
+    return cell;
 }
 
 void Grid::Reset() {
+    ++version;
+    edits.clear();
+    editBase = version;
+    sourcePos = { -1, -1 };
+    targetPos = { -1, -1 };
+
     for (auto& col : nodes)
         for (auto& node : col) {
             node.setState(NodeState::Unblocked);
             node.Reset(NodeState::Unblocked);
         }
+    labelComponents();
+    buildPyramid();
 }
 
 void Grid::updateColor(Pos mousePos, NodeState state) {
-    for (auto& col : nodes) {
-        for (auto& node : col) {
-            if (node.contains(mousePos)) {
-                Position clickedPos = node.getWorldPosition();
-                NodeState current = node.getState();
+    if (auto cell = cellAt(mousePos))
+        setCell(*cell, state);
+}
 
-                if ((state == NodeState::Source && current == NodeState::Target) ||
-                    (state == NodeState::Target && current == NodeState::Source)) {
-                    return;
-                }
+void Grid::setCell(Position position, NodeState state) {
+    Node& node = nodes[position.x][position.y];
+    NodeState current = node.getState();
 
-                if (state == NodeState::Source) {
-                    if (sourcePos != Position(-1, -1)) {
-                        Node& prevSource = nodes[sourcePos.x][sourcePos.y];
-                        prevSource.setState(NodeState::Unblocked);
-                        prevSource.changeColor(NodeState::Unblocked);
-                    }
+    if ((state == NodeState::Source && current == NodeState::Target) ||
+        (state == NodeState::Target && current == NodeState::Source)) {
+        return;
+    }
 
-                    sourcePos = clickedPos;
-                    node.setState(NodeState::Source);
-                    node.changeColor(NodeState::Source);
-                }
+    if (state == NodeState::Source) {
+        if (sourcePos != Position(-1, -1)) {
+            Node& prevSource = nodes[sourcePos.x][sourcePos.y];
+            prevSource.setState(NodeState::Unblocked);
+            prevSource.changeColor(NodeState::Unblocked);
+        }
 
-                else if (state == NodeState::Target) {
-                    if (targetPos != Position(-1, -1)) {
-                        Node& prevTarget = nodes[targetPos.x][targetPos.y];
-                        prevTarget.setState(NodeState::Unblocked);
-                        prevTarget.changeColor(NodeState::Unblocked);
-                    }
+        sourcePos = position;
+        node.setState(NodeState::Source);
+        node.changeColor(NodeState::Source);
+    }
 
-                    targetPos = clickedPos;
-                    node.setState(NodeState::Target);
-                    node.changeColor(NodeState::Target);
-                }
+    else if (state == NodeState::Target) {
+        if (targetPos != Position(-1, -1)) {
+            Node& prevTarget = nodes[targetPos.x][targetPos.y];
+            prevTarget.setState(NodeState::Unblocked);
+            prevTarget.changeColor(NodeState::Unblocked);
+        }
 
-                else {
-                    if (current != NodeState::Source && current != NodeState::Target) {
-                        node.setState(state);
-                        node.changeColor(state);
+        targetPos = position;
+        node.setState(NodeState::Target);
+        node.changeColor(NodeState::Target);
+    }
+
+    else {
+        if (current != NodeState::Source && current != NodeState::Target) {
+            node.setState(state);
+            node.changeColor(state);
+        }
+    }
+
+    if ((current == NodeState::Blocked) != (node.getState() == NodeState::Blocked)) {
+        ++version;
+        updatePyramid(position, node.getState() == NodeState::Blocked ? 1 : -1);
+        if (node.getState() == NodeState::Blocked)
+            splitComponents(position);
+        else
+            joinComponents(position);
+        if (edits.size() >= maxEdits) {
+            edits.erase(edits.begin(), edits.begin() + maxEdits / 2);
+            editBase += maxEdits / 2;
+        }
+        edits.push_back(position);
+    }
+}
+
+int Grid::findComponent(int label) const {
+    while (componentParent[label] != label) {
+        componentParent[label] = componentParent[componentParent[label]];
+        label = componentParent[label];
+    }
+    return label;
+}
+
+int Grid::getComponent(Position position) const {
+    int label = componentLabel[position.x * rows + position.y];
+    return label == -1 ? -1 : findComponent(label);
+}
+
+// Full flood fill, used whenever the whole grid changes at once
+void Grid::labelComponents() {
+    componentLabel.assign(cols * rows, -1);
+    componentParent.clear();
+    componentVisit.assign(cols * rows, 0);
+    componentOwner.assign(cols * rows, 0);
+    componentStamp = 0;
+
+    std::vector<int> stack;
+    for (int start = 0; start < cols * rows; ++start) {
+        if (componentLabel[start] != -1 || nodes[start / rows][start % rows].getState() == NodeState::Blocked)
+            continue;
+
+        int label = static_cast<int>(componentParent.size());
+        componentParent.push_back(label);
+        componentLabel[start] = label;
+        stack.assign(1, start);
+        while (!stack.empty()) {
+            int cell = stack.back();
+            stack.pop_back();
+            int x = cell / rows, y = cell % rows;
+            for (int dx = -1; dx <= 1; ++dx) {
+                for (int dy = -1; dy <= 1; ++dy) {
+                    int nx = x + dx, ny = y + dy;
+                    if (nx < 0 || nx >= cols || ny < 0 || ny >= rows)
+                        continue;
+                    int next = nx * rows + ny;
+                    if (componentLabel[next] == -1 && nodes[nx][ny].getState() != NodeState::Blocked) {
+                        componentLabel[next] = label;
+                        stack.push_back(next);
                     }
                 }
+            }
+        }
+    }
+    componentCount = static_cast<int>(componentParent.size());
+}
+
+// A freed cell merges every component around it
+void Grid::joinComponents(Position cell) {
+    int joined = -1;
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            int nx = cell.x + dx, ny = cell.y + dy;
+            if ((dx == 0 && dy == 0) || nx < 0 || nx >= cols || ny < 0 || ny >= rows || componentLabel[nx * rows + ny] == -1)
+                continue;
+            int root = findComponent(componentLabel[nx * rows + ny]);
+            if (joined == -1) {
+                joined = root;
+            }
+            else if (root != joined) {
+                componentParent[root] = joined;
+                --componentCount;
+            }
+        }
+    }
+    if (joined == -1) {
+        joined = static_cast<int>(componentParent.size());
+        componentParent.push_back(joined);
+        ++componentCount;
+    }
+    componentLabel[cell.x * rows + cell.y] = joined;
+}
+
+// A new wall can only split its component if the free cells around it fall into
+// separate groups. One search per group runs in lockstep; groups that meet are
+// merged, and once at most one group is still growing, every group that finished
+// on its own is a new component. Only those, the smaller parts, are relabelled.
+void Grid::splitComponents(Position wall) {
+    componentLabel[wall.x * rows + wall.y] = -1;
+
+    std::vector<int> around;
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            int nx = wall.x + dx, ny = wall.y + dy;
+            if ((dx == 0 && dy == 0) || nx < 0 || nx >= cols || ny < 0 || ny >= rows || componentLabel[nx * rows + ny] == -1)
+                continue;
+            around.push_back(nx * rows + ny);
+        }
+    }
+    if (around.empty()) {
+        --componentCount;
+        return;
+    }
+
+    // Cells around the wall that touch each other are already connected
+    std::vector<int> group(around.size());
+    for (size_t i = 0; i < around.size(); ++i)
+        group[i] = static_cast<int>(i);
+    auto findGroup = [&](int i) {
+        while (group[i] != i)
+            i = group[i];
+        return i;
+    };
+    for (size_t i = 0; i < around.size(); ++i) {
+        for (size_t j = i + 1; j < around.size(); ++j) {
+            int ax = around[i] / rows, ay = around[i] % rows, bx = around[j] / rows, by = around[j] % rows;
+            if (std::abs(ax - bx) <= 1 && std::abs(ay - by) <= 1)
+                group[findGroup(static_cast<int>(j))] = findGroup(static_cast<int>(i));
+        }
+    }
+
+    std::vector<std::vector<int>> searches; // visited cells in BFS order
+    for (size_t i = 0; i < around.size(); ++i)
+        if (findGroup(static_cast<int>(i)) == static_cast<int>(i))
+            searches.push_back({ around[i] });
+    if (searches.size() == 1)
+        return;
+
+    if (++componentStamp == 0) {
+        std::fill(componentVisit.begin(), componentVisit.end(), 0);
+        componentStamp = 1;
+    }
+    group.assign(searches.size(), 0);
+    for (size_t i = 0; i < searches.size(); ++i) {
+        group[i] = static_cast<int>(i);
+        componentVisit[searches[i][0]] = componentStamp;
+        componentOwner[searches[i][0]] = static_cast<uint8_t>(i);
+    }
 
-                return; 
+    std::vector<size_t> head(searches.size(), 0);
+    auto growing = [&](int root) {
+        for (size_t i = 0; i < searches.size(); ++i)
+            if (findGroup(static_cast<int>(i)) == root && head[i] < searches[i].size())
+                return true;
+        return false;
+    };
+    while (true) {
+        int growingGroups = 0;
+        for (size_t i = 0; i < searches.size(); ++i)
+            if (findGroup(static_cast<int>(i)) == static_cast<int>(i) && growing(static_cast<int>(i)))
+                ++growingGroups;
+        if (growingGroups <= 1)
+            break;
+
+        for (size_t i = 0; i < searches.size(); ++i) {
+            if (head[i] >= searches[i].size())
+                continue;
+            int cell = searches[i][head[i]++];
+            int x = cell / rows, y = cell % rows;
+            for (int dx = -1; dx <= 1; ++dx) {
+                for (int dy = -1; dy <= 1; ++dy) {
+                    int nx = x + dx, ny = y + dy;
+                    if (nx < 0 || nx >= cols || ny < 0 || ny >= rows || componentLabel[nx * rows + ny] == -1)
+                        continue;
+                    int next = nx * rows + ny;
+                    if (componentVisit[next] != componentStamp) {
+                        componentVisit[next] = componentStamp;
+                        componentOwner[next] = static_cast<uint8_t>(i);
+                        searches[i].push_back(next);
+                    }
+                    else if (findGroup(componentOwner[next]) != findGroup(static_cast<int>(i))) {
+                        group[findGroup(componentOwner[next])] = findGroup(static_cast<int>(i));
+                    }
+                }
             }
         }
     }
+
+    // The group still growing (or else the largest) keeps the old label
+    std::vector<size_t> cells(searches.size(), 0);
+    int keep = -1;
+    for (size_t i = 0; i < searches.size(); ++i)
+        cells[findGroup(static_cast<int>(i))] += searches[i].size();
+    for (size_t i = 0; i < searches.size(); ++i) {
+        int root = findGroup(static_cast<int>(i));
+        if (root != static_cast<int>(i))
+            continue;
+        if (growing(root)) {
+            keep = root;
+            break;
+        }
+        if (keep == -1 || cells[root] > cells[keep])
+            keep = root;
+    }
+
+    std::vector<int> newLabel(searches.size(), -1);
+    for (size_t i = 0; i < searches.size(); ++i) {
+        int root = findGroup(static_cast<int>(i));
+        if (root == keep)
+            continue;
+        if (newLabel[root] == -1) {
+            newLabel[root] = static_cast<int>(componentParent.size());
+            componentParent.push_back(newLabel[root]);
+            ++componentCount;
+        }
+        for (int cell : searches[i])
+            componentLabel[cell] = newLabel[root];
+    }
+}
+
+bool Grid::getEditsSince(unsigned int since, std::vector<Position>& out) const {
+    if (since < editBase || since > version)
+        return false;
+    out.assign(edits.begin() + (since - editBase), edits.end());
+    return true;
 }
@@ -5,10 +5,12 @@
 #include <iostream>
 #include <optional>
 #include <unordered_set>
+#include <cstdint>
 
+// Packs both coordinates into one key; x ^ (y << 1) collided for whole rows
 struct Vector2i_Hash {
     size_t operator()(const sf::Vector2i& p) const {
-        return std::hash<int>()(p.x) ^ (std::hash<int>()(p.y) << 1);
+        return std::hash<uint64_t>()((static_cast<uint64_t>(static_cast<uint32_t>(p.x)) << 32) | static_cast<uint32_t>(p.y));
     }
 };
 
@@ -18,6 +20,22 @@ private:
     float size;
     float guiMarginRight = 100.f;
 
+    unsigned int version = 0; // bumped whenever the set of blocked cells changes
+
+    // Cells whose blocked status changed, one per version after editBase
+    std::vector<Position> edits;
+    unsigned int editBase = 0;
+    static constexpr size_t maxEdits = 4096;
+
+    // 8-connected components of free cells; a cell's raw label leads to its
+    // component through union-find, so joining regions never relabels cells
+    std::vector<int> componentLabel;          // [x * rows + y], -1 when blocked
+    mutable std::vector<int> componentParent; // per raw label
+    int componentCount = 0;
+    std::vector<unsigned int> componentVisit; // split searches, stamped per split
+    std::vector<uint8_t> componentOwner;
+    unsigned int componentStamp = 0;
+
     Position sourcePos = { -1, -1 };
     Position targetPos = { -1, -1 };
 
@@ -25,19 +43,66 @@ private:
     sf::RectangleShape* drawable_area;
 
     std::vector<std::vector<Node>> nodes;
+    Position fixedDimensions = { 0, 0 }; // {0, 0} to fit the drawable area
+
+    // Blocked cells per 2^(l+1)-cell square block at level l, for drawing zoomed out
+    std::vector<std::vector<int>> blockedPyramid;
+    bool levelOfDetail = true;
+    float lodPixels = 4.0f; // below this many pixels per cell, blocks are drawn instead
+    int drawnQuads = 0;
+    int lodBlock = 0;
+
+    // Per-cell overlay, one texel per cell
+    sf::Texture overlayTexture;
+    std::vector<sf::Uint8> overlayPixels;
+    bool overlayLoaded = false;
+
+    int findComponent(int label) const;
+    void labelComponents();
+    void joinComponents(Position cell);
+    void splitComponents(Position wall);
+    void buildPyramid();
+    void updatePyramid(Position cell, int delta);
+    void drawBlocks(int level, int x0, int y0, int x1, int y1);
 
 public:
     Grid(sf::RenderWindow& window, sf::RectangleShape& background);
 
     void draw();
+    void drawPath(const std::vector<Position>& waypoints);
+    void drawPath(const std::vector<Pos>& points);
+    void drawHeatmap(const std::vector<float>& values);  // [x * rows + y], FLT_MAX cells left out
+    void drawArrows(const std::vector<Position>& steps); // [x * rows + y], one step per cell
+    void drawMarkers(const std::vector<Position>& cells, sf::Color color);
+    void setOverlay(const std::vector<float>& values);   // [x * rows + y], FLT_MAX cells left out
+    void clearOverlay() { overlayLoaded = false; }
+    void drawOverlay();
 
     void updateColor(Pos mousePos, NodeState state);
+    void setCell(Position position, NodeState state);
     void Reset();
 
     std::optional<Node> on_mouse_hover(Pos mousePos);
+    std::optional<Position> cellAt(Pos point) const;
 
     std::vector<std::vector<Node>>& getNodeData() { return nodes; }
     Position getDimensions();
+    float getCellSize() const { return size; }
+    void setFixedDimensions(Position cells) { fixedDimensions = cells; } // takes effect on reinitialize
+    void setLevelOfDetail(bool enabled) { levelOfDetail = enabled; }
+    int getDrawnQuads() const { return drawnQuads; }
+    int getLodBlock() const { return lodBlock; } // cells per block side in the last draw, 0 if cells were drawn
+    bool isBlocked(Position position) const { return nodes[position.x][position.y].getState() == NodeState::Blocked; }
+    bool lineOfSight(Position from, Position to) const; // passes between diagonally touching walls, as the searches do
+    std::vector<uint8_t> getBlockedMask() const; // [x * rows + y]
+    uint64_t contentHash() const;
+    unsigned int getVersion() const { return version; }
+    bool getEditsSince(unsigned int since, std::vector<Position>& out) const; // false if the log no longer reaches back
+    int getComponent(Position position) const;
+    bool sameComponent(Position a, Position b) const { return getComponent(a) != -1 && getComponent(a) == getComponent(b); }
+    int getComponentCount() const { return componentCount; }
+    const Position& getSourcePos() const { return sourcePos; }
+    const Position& getTargetPos() const { return targetPos; }
 
     void initialize();
     void reinitialize(float newSize, float newMarginRight = 400.f);
@@ -0,0 +1,204 @@
+#include "LandmarkFile.h"
+#include <fstream>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static constexpr uint32_t Magic = 0x32544c41; // "ALT2"
+
+struct LandmarkFileHeader {
+    uint32_t magic;
+    int32_t cols, rows, count;
+    uint64_t gridHash;
+    float scale;
+    int32_t requested;
+    uint64_t payloadBytes;
+};
+
+// Read-only mapping of a whole file
+class MappedFile
+{
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+            return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+            return;
+        data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        size = data ? static_cast<size_t>(fileSize.QuadPart) : 0;
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view != MAP_FAILED) {
+                data = static_cast<const uint8_t*>(view);
+                size = static_cast<size_t>(info.st_size);
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data)
+            UnmapViewOfFile(data);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+#else
+        if (data)
+            munmap(const_cast<uint8_t*>(data), size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* getData() const { return data; }
+    size_t getSize() const { return size; }
+};
+
+// Value 0 marks an unreachable cell, otherwise zigzag(second difference) + 1
+static void writeVarint(std::vector<uint8_t>& out, uint32_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static bool readVarint(const uint8_t*& in, const uint8_t* end, uint32_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 35 && in < end; shift += 7) {
+        uint8_t byte = *in++;
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+bool LandmarkFile::save(const std::string& path, uint64_t gridHash, const LandmarkTables& tables)
+{
+    size_t k = tables.landmarks.size();
+    size_t cells = static_cast<size_t>(tables.cols) * tables.rows;
+
+    std::vector<uint8_t> payload;
+    payload.reserve(cells * k);
+    for (size_t l = 0; l < k; ++l) {
+        int previous = 0, previousDelta = 0;
+        for (size_t i = 0; i < cells; ++i) {
+            uint16_t value = tables.table[i * k + l];
+            if (value == Landmarks::Unreachable) {
+                writeVarint(payload, 0);
+                continue;
+            }
+            // distances change with a near constant slope, so the second difference is small
+            int delta = value - previous;
+            int change = delta - previousDelta;
+            previous = value;
+            previousDelta = delta;
+            writeVarint(payload, ((static_cast<uint32_t>(change) << 1) ^ static_cast<uint32_t>(change >> 31)) + 1);
+        }
+    }
+
+    LandmarkFileHeader header = { Magic, tables.cols, tables.rows, static_cast<int32_t>(k), gridHash, tables.scale, tables.requested, payload.size() };
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& landmark : tables.landmarks) {
+        int32_t xy[2] = { landmark.x, landmark.y };
+        out.write(reinterpret_cast<const char*>(xy), sizeof(xy));
+    }
+    out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+    return static_cast<bool>(out);
+}
+
+bool LandmarkFile::load(const std::string& path, uint64_t gridHash, Position dimensions, LandmarkTables& tables)
+{
+    MappedFile file(path);
+    const uint8_t* in = file.getData();
+    if (!in || file.getSize() < sizeof(LandmarkFileHeader))
+        return false;
+
+    LandmarkFileHeader header;
+    std::memcpy(&header, in, sizeof(header));
+    if (header.magic != Magic || header.gridHash != gridHash || header.count <= 0 || header.cols != dimensions.x || header.rows != dimensions.y)
+        return false;
+
+    size_t k = static_cast<size_t>(header.count);
+    size_t cells = static_cast<size_t>(header.cols) * header.rows;
+    size_t landmarkBytes = k * 2 * sizeof(int32_t);
+    if (file.getSize() != sizeof(header) + landmarkBytes + header.payloadBytes)
+        return false;
+    if (cells * k > header.payloadBytes) // every entry takes at least one byte
+        return false;
+    in += sizeof(header);
+
+    LandmarkTables loaded;
+    loaded.cols = header.cols;
+    loaded.rows = header.rows;
+    loaded.scale = header.scale;
+    loaded.requested = header.requested;
+    for (size_t l = 0; l < k; ++l) {
+        int32_t xy[2];
+        std::memcpy(xy, in, sizeof(xy));
+        in += sizeof(xy);
+        if (xy[0] < 0 || xy[0] >= header.cols || xy[1] < 0 || xy[1] >= header.rows)
+            return false;
+        loaded.landmarks.emplace_back(xy[0], xy[1]);
+    }
+
+    const uint8_t* end = in + header.payloadBytes;
+    loaded.table.resize(cells * k);
+    for (size_t l = 0; l < k; ++l) {
+        int previous = 0, previousDelta = 0;
+        for (size_t i = 0; i < cells; ++i) {
+            uint32_t code;
+            if (!readVarint(in, end, code))
+                return false;
+            if (code == 0) {
+                loaded.table[i * k + l] = Landmarks::Unreachable;
+                continue;
+            }
+            --code;
+            previousDelta += static_cast<int>(code >> 1) ^ -static_cast<int>(code & 1);
+            previous += previousDelta;
+            loaded.table[i * k + l] = static_cast<uint16_t>(previous);
+        }
+    }
+
+    tables = std::move(loaded);
+    return true;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Landmarks.h"
+#include <string>
+
+// Compressed sidecar of landmark tables, keyed by a hash of the grid contents.
+// Entries are stored landmark-major as zigzag varint second differences along
+// each column, and the file is memory-mapped on load.
+class LandmarkFile
+{
+public:
+	static bool save(const std::string& path, uint64_t gridHash, const LandmarkTables& tables);
+	// false if the file is missing, corrupt, or was built for other grid contents or dimensions
+	static bool load(const std::string& path, uint64_t gridHash, Position dimensions, LandmarkTables& tables);
+};
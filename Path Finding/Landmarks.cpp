@@ -0,0 +1,194 @@
+#include "Landmarks.h"
+#include "LandmarkFile.h"
+#include <queue>
+#include <chrono>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+
+// 8-connected distances with the same step costs as Astar
+static std::vector<float> dijkstra(const std::vector<uint8_t>& blocked, int cols, int rows, Position from)
+{
+    auto index = [rows](Position p) { return static_cast<size_t>(p.x) * rows + p.y; };
+    std::vector<float> dist(static_cast<size_t>(cols) * rows, FLT_MAX);
+    typedef std::pair<float, Position> Entry;
+    auto later = [](const Entry& a, const Entry& b) { return a.first > b.first; };
+    std::priority_queue<Entry, std::vector<Entry>, decltype(later)> open(later);
+
+    dist[index(from)] = 0.0f;
+    open.emplace(0.0f, from);
+
+    while (!open.empty()) {
+        auto [d, pos] = open.top();
+        open.pop();
+        if (d > dist[index(pos)])
+            continue;
+
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                Position next = pos + Position(dx, dy);
+                if ((dx == 0 && dy == 0) || next.x < 0 || next.x >= cols || next.y < 0 || next.y >= rows)
+                    continue;
+                if (blocked[index(next)])
+                    continue;
+
+                float dnew = d + ((dx != 0 && dy != 0) ? 1.414f : 1.0f);
+                if (dnew < dist[index(next)]) {
+                    dist[index(next)] = dnew;
+                    open.emplace(dnew, next);
+                }
+            }
+        }
+    }
+    return dist;
+}
+
+LandmarkTables Landmarks::compute(std::vector<uint8_t> blocked, int cols, int rows, int count)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    LandmarkTables result;
+    result.cols = cols;
+    result.rows = rows;
+    result.requested = count;
+
+    size_t cells = static_cast<size_t>(cols) * rows;
+    auto seed = std::find(blocked.begin(), blocked.end(), 0);
+    if (seed == blocked.end() || count <= 0)
+        return result;
+
+    // Farthest point from the seed starts the set, then each landmark is the
+    // cell farthest from all chosen ones
+    size_t seedIndex = seed - blocked.begin();
+    std::vector<std::vector<float>> distances;
+    std::vector<float> nearest = dijkstra(blocked, cols, rows, Position(static_cast<int>(seedIndex / rows), static_cast<int>(seedIndex % rows)));
+    for (int k = 0; k < count; ++k) {
+        size_t best = cells;
+        float bestDist = 0.0f;
+        for (size_t i = 0; i < cells; ++i) {
+            if (nearest[i] != FLT_MAX && nearest[i] > bestDist) {
+                bestDist = nearest[i];
+                best = i;
+            }
+        }
+        if (best == cells)
+            break;
+
+        Position landmark(static_cast<int>(best / rows), static_cast<int>(best % rows));
+        result.landmarks.push_back(landmark);
+        distances.push_back(dijkstra(blocked, cols, rows, landmark));
+
+        const auto& dist = distances.back();
+        for (size_t i = 0; i < cells; ++i)
+            nearest[i] = std::min(nearest[i], dist[i]);
+    }
+
+    float maxDist = 0.0f;
+    for (const auto& dist : distances)
+        for (float d : dist)
+            if (d != FLT_MAX)
+                maxDist = std::max(maxDist, d);
+    result.scale = maxDist > 0.0f ? (Unreachable - 1) / maxDist : 1.0f;
+
+    size_t k = result.landmarks.size();
+    result.table.assign(cells * k, Unreachable);
+    for (size_t l = 0; l < k; ++l)
+        for (size_t i = 0; i < cells; ++i)
+            if (distances[l][i] != FLT_MAX)
+                result.table[i * k + l] = static_cast<uint16_t>(distances[l][i] * result.scale + 0.5f);
+
+    result.buildMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void Landmarks::adopt(LandmarkTables&& newTables, unsigned int version)
+{
+    tables = std::move(newTables);
+    builtVersion = version;
+    built = !tables.landmarks.empty();
+    loadGoalRow();
+}
+
+std::string Landmarks::sidecarPath(uint64_t hash) const
+{
+    std::ostringstream path;
+    path << directory << "/" << std::hex << std::setw(16) << std::setfill('0') << hash << ".alt";
+    return path.str();
+}
+
+void Landmarks::build(int count)
+{
+    Position dim = grid.getDimensions();
+    adopt(compute(grid.getBlockedMask(), dim.x, dim.y, count), grid.getVersion());
+    loadedFromFile = false;
+}
+
+void Landmarks::prepare(int count)
+{
+    requestedCount = count;
+    if (pending.valid())
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t hash = grid.contentHash();
+    LandmarkTables loaded;
+    if (LandmarkFile::load(sidecarPath(hash), hash, grid.getDimensions(), loaded) && loaded.requested == count) {
+        adopt(std::move(loaded), grid.getVersion());
+        loadedFromFile = true;
+        loadMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return;
+    }
+
+    // Snapshot the grid so the worker never touches live nodes
+    Position dim = grid.getDimensions();
+    pendingVersion = grid.getVersion();
+    pendingHash = hash;
+    pending = std::async(std::launch::async, &Landmarks::compute, grid.getBlockedMask(), dim.x, dim.y, count);
+}
+
+void Landmarks::poll()
+{
+    if (pending.valid() && pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        LandmarkTables fresh = pending.get();
+        triedVersion = pendingVersion;
+        if (pendingVersion == grid.getVersion()) {
+            LandmarkFile::save(sidecarPath(pendingHash), pendingHash, fresh);
+            adopt(std::move(fresh), pendingVersion);
+            loadedFromFile = false;
+        }
+    }
+
+    if (requestedCount > 0 && !isValid() && !pending.valid() && triedVersion != grid.getVersion())
+        prepare(requestedCount);
+}
+
+void Landmarks::setGoal(Position target)
+{
+    goal = target;
+    loadGoalRow();
+}
+
+void Landmarks::loadGoalRow()
+{
+    size_t k = tables.landmarks.size();
+    goalRow.assign(k, Unreachable);
+    if (isValid() && goal.x >= 0 && goal.x < tables.cols && goal.y >= 0 && goal.y < tables.rows)
+        std::copy_n(tables.table.begin() + index(goal) * k, k, goalRow.begin());
+}
+
+// max over landmarks of |d(L, t) - d(L, n)|, less one rounding step of each entry
+float Landmarks::heuristic(Position position) const
+{
+    size_t k = tables.landmarks.size();
+    if (goalRow.size() != k)
+        return 0.0f;
+    const uint16_t* row = &tables.table[index(position) * k];
+
+    int best = 0;
+    for (size_t l = 0; l < k; ++l) {
+        if (row[l] == Unreachable || goalRow[l] == Unreachable)
+            continue;
+        best = std::max(best, std::abs(static_cast<int>(row[l]) - static_cast<int>(goalRow[l])));
+    }
+    return std::max(0, best - 1) / tables.scale;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Grid.h"
+#include <vector>
+#include <cstdint>
+#include <future>
+#include <string>
+
+// Landmark distance tables, independent of the Grid they were built from
+struct LandmarkTables {
+	int cols = 0, rows = 0;
+	std::vector<Position> landmarks;
+	int requested = 0;           // count asked for; fewer are found when the map has few free cells
+	std::vector<uint16_t> table; // [cell * count + landmark], distance * scale
+	float scale = 1.0f;          // fixed-point factor of the table entries
+	float buildMs = 0.0f;
+};
+
+// ALT heuristic (A*, Landmarks, Triangle inequality): exact distances from a
+// few landmarks bound the distance between any two cells from below.
+class Landmarks
+{
+private:
+	Grid& grid;
+
+	LandmarkTables tables;
+	unsigned int builtVersion = 0;
+	bool built = false;
+
+	// distances of the current goal, cached per query
+	Position goal = { -1, -1 };
+	std::vector<uint16_t> goalRow;
+
+	// background rebuild of stale tables, persisted as a sidecar file
+	int requestedCount = 0;
+	std::string directory = ".";
+	std::future<LandmarkTables> pending;
+	unsigned int pendingVersion = 0;
+	unsigned int triedVersion = ~0u; // last version a build finished for, so a failed one is not retried every frame
+	uint64_t pendingHash = 0;
+	bool loadedFromFile = false;
+	float loadMs = 0.0f;
+
+	size_t index(Position p) const { return static_cast<size_t>(p.x) * tables.rows + p.y; }
+	void adopt(LandmarkTables&& newTables, unsigned int version);
+	void loadGoalRow();
+	std::string sidecarPath(uint64_t hash) const;
+
+public:
+	static constexpr uint16_t Unreachable = 0xFFFF;
+
+	Landmarks(Grid& _grid) : grid(_grid) {}
+
+	// Farthest-point selection of count landmarks, one Dijkstra each
+	static LandmarkTables compute(std::vector<uint8_t> blocked, int cols, int rows, int count);
+
+	void build(int count);
+	// Maps the sidecar for the current grid contents, or rebuilds it in the background
+	void prepare(int count);
+	// Adopts a finished background build and restarts it when the grid went stale;
+	// not to be called while a search is using the heuristic
+	void poll();
+
+	bool isValid() const { return built && builtVersion == grid.getVersion(); }
+	bool isBuilding() const { return pending.valid(); }
+	bool isLoadedFromFile() const { return loadedFromFile; }
+
+	void setGoal(Position target);
+	float heuristic(Position position) const;
+
+	int getCount() const { return static_cast<int>(tables.landmarks.size()); }
+	const std::vector<Position>& getLandmarks() const { return tables.landmarks; }
+	float getBuildMs() const { return tables.buildMs; }
+	float getLoadMs() const { return loadMs; }
+	size_t getMemoryBytes() const { return tables.table.size() * sizeof(uint16_t); }
+	void setDirectory(const std::string& newDirectory) { directory = newDirectory; }
+};
@@ -0,0 +1,75 @@
+#include "MapfScenario.h"
+#include <fstream>
+#include <sstream>
+
+bool MapfScenario::loadMap(const std::string& mapPath, MapfScenario& scenario)
+{
+    std::ifstream in(mapPath);
+    if (!in)
+        return false;
+
+    std::string word;
+    int width = 0, height = 0;
+    while (in >> word && word != "map") {
+        if (word == "height")
+            in >> height;
+        else if (word == "width")
+            in >> width;
+        else
+            in >> word; // type
+    }
+    if (word != "map" || width <= 0 || height <= 0)
+        return false;
+
+    scenario.cols = width;
+    scenario.rows = height;
+    scenario.blocked.assign(static_cast<size_t>(width) * height, 1);
+    std::string line;
+    for (int y = 0; y < height; ++y) {
+        if (!(in >> line) || static_cast<int>(line.size()) < width)
+            return false;
+        for (int x = 0; x < width; ++x) {
+            char terrain = line[x];
+            scenario.blocked[static_cast<size_t>(x) * height + y] = !(terrain == '.' || terrain == 'G' || terrain == 'S');
+        }
+    }
+    return true;
+}
+
+bool MapfScenario::load(const std::string& scenarioPath, MapfScenario& scenario)
+{
+    std::ifstream in(scenarioPath);
+    if (!in)
+        return false;
+
+    scenario = MapfScenario();
+    std::string directory;
+    size_t slash = scenarioPath.find_last_of("/\\");
+    if (slash != std::string::npos)
+        directory = scenarioPath.substr(0, slash + 1);
+
+    std::string line, mapName;
+    while (std::getline(in, line)) {
+        if (line.empty() || line.rfind("version", 0) == 0)
+            continue;
+
+        // bucket, map, map width, map height, start x, start y, goal x, goal y, optimal length
+        std::istringstream fields(line);
+        int bucket, width, height;
+        MapfAgent agent;
+        std::string name;
+        if (!(fields >> bucket >> name >> width >> height >> agent.start.x >> agent.start.y >> agent.goal.x >> agent.goal.y))
+            return false;
+        if (mapName.empty()) {
+            mapName = name.substr(name.find_last_of("/\\") + 1);
+            if (!loadMap(directory + mapName, scenario) || scenario.cols != width || scenario.rows != height)
+                return false;
+        }
+
+        for (Position cell : { agent.start, agent.goal })
+            if (cell.x < 0 || cell.x >= scenario.cols || cell.y < 0 || cell.y >= scenario.rows || scenario.blocked[static_cast<size_t>(cell.x) * scenario.rows + cell.y])
+                return false;
+        scenario.agents.push_back(agent);
+    }
+    return !scenario.agents.empty();
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Grid.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// One agent of a scenario
+struct MapfAgent {
+	Position start;
+	Position goal;
+};
+
+// A MAPF benchmark instance in the MovingAI format: a .scen file whose
+// rows name a .map file (looked up next to the .scen) and give each
+// agent's start and goal. Map rows are y, columns are x; '.', 'G' and 'S'
+// are passable, every other terrain is a wall.
+struct MapfScenario {
+	int cols = 0, rows = 0;
+	std::vector<uint8_t> blocked; // [x * rows + y]
+	std::vector<MapfAgent> agents;
+
+	// false if either file is missing or malformed
+	static bool load(const std::string& scenarioPath, MapfScenario& scenario);
+	static bool loadMap(const std::string& mapPath, MapfScenario& scenario);
+};
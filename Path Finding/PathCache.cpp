@@ -0,0 +1,291 @@
+#include "PathCache.h"
+#include <cmath>
+#include <algorithm>
+
+static Position direction(Position from, Position to)
+{
+    return { (to.x > from.x) - (to.x < from.x), (to.y > from.y) - (to.y < from.y) };
+}
+
+// Unit steps use the grid's move costs, longer any-angle segments their length
+static float segmentCost(Position a, Position b)
+{
+    int dx = std::abs(a.x - b.x);
+    int dy = std::abs(a.y - b.y);
+    if (dx <= 1 && dy <= 1)
+        return (dx && dy) ? 1.414f : static_cast<float>(dx + dy);
+    return std::sqrt(static_cast<float>(dx * dx + dy * dy));
+}
+
+static float octile(Position a, Position b)
+{
+    int dx = std::abs(a.x - b.x);
+    int dy = std::abs(a.y - b.y);
+    return 1.414f * std::min(dx, dy) + static_cast<float>(std::abs(dx - dy));
+}
+
+static float euclidean(Position a, Position b)
+{
+    float dx = static_cast<float>(a.x - b.x);
+    float dy = static_cast<float>(a.y - b.y);
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+void PathCache::clear()
+{
+    lru.clear();
+    entries.clear();
+    byId.clear();
+    byTarget.clear();
+    buckets.assign(static_cast<size_t>(bucketCols) * bucketRows, {});
+    staleEntries = 0;
+}
+
+void PathCache::setCapacity(size_t newCapacity)
+{
+    capacity = std::max<size_t>(1, newCapacity);
+    while (lru.size() > capacity) {
+        erase(std::prev(lru.end()));
+        ++evictions;
+    }
+    compact();
+}
+
+// Catches up with the grid's edit log, dropping everything if it no longer reaches back
+void PathCache::sync()
+{
+    Position dim = grid.getDimensions();
+    if (dim != Position(cols, rows)) {
+        cols = dim.x;
+        rows = dim.y;
+        bucketCols = (cols + bucketSize - 1) / bucketSize;
+        bucketRows = (rows + bucketSize - 1) / bucketSize;
+        clear();
+        syncedVersion = grid.getVersion();
+        return;
+    }
+    if (syncedVersion == grid.getVersion())
+        return;
+
+    std::vector<Position> cells;
+    if (!grid.getEditsSince(syncedVersion, cells)) {
+        invalidations += lru.size();
+        clear();
+        syncedVersion = grid.getVersion();
+        return;
+    }
+    syncedVersion = grid.getVersion();
+
+    for (Position cell : cells) {
+        bool blocked = grid.isBlocked(cell);
+        std::vector<uint32_t>& bucket = buckets[(cell.x / bucketSize) * bucketRows + cell.y / bucketSize];
+        size_t kept = 0;
+        for (uint32_t id : bucket) {
+            auto found = byId.find(id);
+            if (found == byId.end())
+                continue;
+            const Entry& entry = *found->second;
+            bool inBox = cell.x >= entry.minX && cell.x <= entry.maxX && cell.y >= entry.minY && cell.y <= entry.maxY;
+            if (inBox && (blocked ? onPath(entry, cell) : canShorten(entry, cell))) {
+                erase(found->second);
+                ++invalidations;
+                continue;
+            }
+            bucket[kept++] = id;
+        }
+        bucket.resize(kept);
+    }
+    if (staleEntries > capacity)
+        compact();
+}
+
+bool PathCache::lookup(const Key& key, SearchResult& result)
+{
+    auto found = entries.find(key);
+    if (found != entries.end()) {
+        lru.splice(lru.begin(), lru, found->second);
+        expand(*found->second, result.waypoints);
+        result.cost = found->second->cost;
+        ++hits;
+        return true;
+    }
+
+    // A cached optimal path to the same target that passes the source
+    if (key.weight > 1.0f)
+        return false;
+    Position source = key.source;
+    auto candidates = byTarget.find({ { -1, -1 }, key.target, key.method, key.weight });
+    if (candidates == byTarget.end())
+        return false;
+
+    std::vector<uint32_t>& ids = candidates->second;
+    std::vector<Position> points;
+    size_t kept = 0;
+    bool reused = false;
+    for (uint32_t id : ids) {
+        auto entry = byId.find(id);
+        if (entry == byId.end())
+            continue;
+        ids[kept++] = id;
+        const Entry& e = *entry->second;
+        if (reused || source.x < e.minX || source.x > e.maxX || source.y < e.minY || source.y > e.maxY)
+            continue;
+
+        expand(e, points);
+        auto at = std::find(points.begin(), points.end(), source);
+        if (at == points.end())
+            continue;
+        result.waypoints.assign(at, points.end());
+        result.cost = 0.0f;
+        for (size_t i = 1; i < result.waypoints.size(); ++i)
+            result.cost += segmentCost(result.waypoints[i - 1], result.waypoints[i]);
+        lru.splice(lru.begin(), lru, entry->second);
+        ++suffixHits;
+        reused = true;
+    }
+    ids.resize(kept);
+    if (ids.empty())
+        byTarget.erase(candidates);
+    return reused;
+}
+
+void PathCache::insert(const Key& key, const SearchResult& result)
+{
+    const std::vector<Position>& waypoints = result.waypoints;
+    if (waypoints.empty())
+        return;
+
+    Entry entry;
+    entry.key = key;
+    entry.id = nextId++;
+    entry.cost = result.cost;
+    entry.dense = true;
+    for (size_t i = 1; i < waypoints.size() && entry.dense; ++i)
+        entry.dense = std::abs(waypoints[i].x - waypoints[i - 1].x) <= 1 && std::abs(waypoints[i].y - waypoints[i - 1].y) <= 1;
+
+    if (entry.dense) {
+        entry.turns.push_back(waypoints.front());
+        for (size_t i = 1; i + 1 < waypoints.size(); ++i)
+            if (direction(waypoints[i - 1], waypoints[i]) != direction(waypoints[i], waypoints[i + 1]))
+                entry.turns.push_back(waypoints[i]);
+        if (waypoints.size() > 1)
+            entry.turns.push_back(waypoints.back());
+    }
+    else
+        entry.turns = waypoints;
+    entry.turns.shrink_to_fit();
+
+    // Any cheaper path stays within (cost - |d|) / 2 of the source-target box on each axis
+    Position front = waypoints.front(), back = waypoints.back();
+    int marginX = static_cast<int>(std::ceil((entry.cost - std::abs(front.x - back.x)) / 2.0f)) + 1;
+    int marginY = static_cast<int>(std::ceil((entry.cost - std::abs(front.y - back.y)) / 2.0f)) + 1;
+    entry.minX = std::max(0, std::min(front.x, back.x) - marginX);
+    entry.maxX = std::min(cols - 1, std::max(front.x, back.x) + marginX);
+    entry.minY = std::max(0, std::min(front.y, back.y) - marginY);
+    entry.maxY = std::min(rows - 1, std::max(front.y, back.y) + marginY);
+    for (Position turn : entry.turns) {
+        entry.minX = std::min(entry.minX, turn.x);
+        entry.maxX = std::max(entry.maxX, turn.x);
+        entry.minY = std::min(entry.minY, turn.y);
+        entry.maxY = std::max(entry.maxY, turn.y);
+    }
+
+    for (int bx = entry.minX / bucketSize; bx <= entry.maxX / bucketSize; ++bx)
+        for (int by = entry.minY / bucketSize; by <= entry.maxY / bucketSize; ++by)
+            buckets[bx * bucketRows + by].push_back(entry.id);
+    byTarget[{ { -1, -1 }, key.target, key.method, key.weight }].push_back(entry.id);
+
+    lru.push_front(std::move(entry));
+    entries[lru.front().key] = lru.begin();
+    byId[lru.front().id] = lru.begin();
+    if (lru.size() > capacity) {
+        erase(std::prev(lru.end()));
+        ++evictions;
+    }
+    if (staleEntries > capacity)
+        compact();
+}
+
+// The bucket and target lists forget the id the next time they are walked,
+// or all at once in compact()
+void PathCache::erase(std::list<Entry>::iterator entry)
+{
+    entries.erase(entry->key);
+    byId.erase(entry->id);
+    lru.erase(entry);
+    ++staleEntries;
+}
+
+void PathCache::compact()
+{
+    auto stale = [this](uint32_t id) { return byId.count(id) == 0; };
+    for (auto& bucket : buckets)
+        bucket.erase(std::remove_if(bucket.begin(), bucket.end(), stale), bucket.end());
+    for (auto ids = byTarget.begin(); ids != byTarget.end();) {
+        ids->second.erase(std::remove_if(ids->second.begin(), ids->second.end(), stale), ids->second.end());
+        ids = ids->second.empty() ? byTarget.erase(ids) : std::next(ids);
+    }
+    staleEntries = 0;
+}
+
+void PathCache::expand(const Entry& entry, std::vector<Position>& out) const
+{
+    if (!entry.dense) {
+        out = entry.turns;
+        return;
+    }
+    out.assign(1, entry.turns.front());
+    for (size_t i = 1; i < entry.turns.size(); ++i) {
+        Position step = direction(entry.turns[i - 1], entry.turns[i]);
+        for (Position p = entry.turns[i - 1]; p != entry.turns[i];) {
+            p += step;
+            out.push_back(p);
+        }
+    }
+}
+
+bool PathCache::onPath(const Entry& entry, Position cell) const
+{
+    if (entry.turns.size() == 1)
+        return cell == entry.turns.front();
+
+    for (size_t i = 1; i < entry.turns.size(); ++i) {
+        Position a = entry.turns[i - 1], b = entry.turns[i];
+        if (!entry.dense) {
+            // An any-angle segment may brush any cell around its box
+            if (cell.x >= std::min(a.x, b.x) - 1 && cell.x <= std::max(a.x, b.x) + 1 && cell.y >= std::min(a.y, b.y) - 1 && cell.y <= std::max(a.y, b.y) + 1)
+                return true;
+            continue;
+        }
+        Position step = direction(a, b);
+        int length = std::max(std::abs(b.x - a.x), std::abs(b.y - a.y));
+        int k = step.x != 0 ? (cell.x - a.x) * step.x : (cell.y - a.y) * step.y;
+        if (k >= 0 && k <= length && a + step * k == cell)
+            return true;
+    }
+    return false;
+}
+
+// Through a newly freed cell no path can cost less than the straight-line
+// bound for its kind of move
+bool PathCache::canShorten(const Entry& entry, Position cell) const
+{
+    Position source = entry.turns.front(), target = entry.turns.back();
+    float bound = entry.dense ? octile(source, cell) + octile(cell, target) : euclidean(source, cell) + euclidean(cell, target);
+    return bound < entry.cost - 1e-3f;
+}
+
+// Approximate: entries, their turn lists, and the index slots pointing at them
+size_t PathCache::getMemoryBytes() const
+{
+    size_t bytes = lru.size() * (sizeof(Entry) + 2 * sizeof(void*));
+    for (const Entry& entry : lru)
+        bytes += entry.turns.capacity() * sizeof(Position);
+    bytes += (entries.size() + byTarget.size()) * (sizeof(Key) + 3 * sizeof(void*));
+    bytes += byId.size() * (sizeof(uint32_t) + 3 * sizeof(void*));
+    for (const auto& bucket : buckets)
+        bytes += bucket.capacity() * sizeof(uint32_t);
+    for (const auto& ids : byTarget)
+        bytes += ids.second.capacity() * sizeof(uint32_t);
+    return bytes;
+}
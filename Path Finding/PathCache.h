@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Grid.h"
+#include "Astar.h"
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <chrono>
+#include <cstdint>
+
+// LRU cache of search results keyed by (source, target, heuristic Method,
+// weight), valid for the grid version it last caught up with. Waypoints are
+// kept as turning points only. For optimal (weight 1) searches a miss may
+// still be answered from a cached path to the same target that passes the
+// source, since every suffix of an optimal path is optimal. A weighted
+// path's suffix has no such bound and is never reused.
+//
+// Grid edits evict selectively: a coarse bucket grid indexes each entry by
+// the box that holds every cell able to shorten its path, and an edited
+// cell only evicts the entries that now cross a wall or could go through it.
+class PathCache
+{
+private:
+	static constexpr int bucketSize = 16; // cells per bucket side
+
+	struct Key {
+		Position source, target;
+		int method;
+		float weight;
+		bool operator==(const Key& other) const { return source == other.source && target == other.target && method == other.method && weight == other.weight; }
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& key) const {
+			uint64_t packed = static_cast<uint64_t>(static_cast<uint16_t>(key.source.x)) << 48 | static_cast<uint64_t>(static_cast<uint16_t>(key.source.y)) << 32
+				| static_cast<uint64_t>(static_cast<uint16_t>(key.target.x)) << 16 | static_cast<uint16_t>(key.target.y);
+			return std::hash<uint64_t>()(packed ^ static_cast<uint64_t>(key.method) * 0x9e3779b97f4a7c15ull) ^ std::hash<float>()(key.weight);
+		}
+	};
+
+	struct Entry {
+		Key key;
+		uint32_t id;
+		bool dense;                  // unit steps, stored as runs; otherwise the waypoints as found
+		std::vector<Position> turns; // source, each turn, target
+		float cost;
+		int minX, minY, maxX, maxY;  // cells that could lie on a cheaper path
+	};
+
+	Grid& grid;
+	int cols = 0, rows = 0;
+	unsigned int syncedVersion = 0;
+	size_t capacity;
+
+	std::list<Entry> lru; // most recently used first
+	std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> entries;
+	std::unordered_map<uint32_t, std::list<Entry>::iterator> byId;
+	std::unordered_map<Key, std::vector<uint32_t>, KeyHash> byTarget; // source left at {-1, -1}; stale ids pruned lazily
+	std::vector<std::vector<uint32_t>> buckets;                       // stale ids pruned lazily
+	int bucketCols = 0, bucketRows = 0;
+	uint32_t nextId = 0;
+	size_t staleEntries = 0; // erased since the index lists were last compacted
+
+	long long hits = 0, suffixHits = 0, misses = 0;
+	long long evictions = 0, invalidations = 0;
+
+	void sync();
+	bool lookup(const Key& key, SearchResult& result);
+	void insert(const Key& key, const SearchResult& result);
+	void erase(std::list<Entry>::iterator entry);
+	void compact();
+	void expand(const Entry& entry, std::vector<Position>& out) const;
+	bool onPath(const Entry& entry, Position cell) const;
+	bool canShorten(const Entry& entry, Position cell) const;
+
+public:
+	PathCache(Grid& _grid, size_t _capacity = 1024) : grid(_grid), capacity(_capacity) {}
+
+	// Answers from the cache when it can, otherwise runs search(source, target) and keeps a found path;
+	// weight is the heuristic weight search runs with
+	template <typename Search>
+	SearchResult query(Position source, Position target, Method method, float weight, Search search) {
+		Key key = { source, target, method, weight };
+		auto start = std::chrono::steady_clock::now();
+		sync();
+		SearchResult result;
+		if (lookup(key, result)) {
+			result.timeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+			return result;
+		}
+		++misses;
+		result = search(source, target);
+		if (result.error == NoError)
+			insert(key, result);
+		return result;
+	}
+
+	void update() { sync(); } // evicts entries made stale by grid edits
+	void clear();
+	void setCapacity(size_t newCapacity);
+
+	size_t getEntries() const { return lru.size(); }
+	size_t getCapacity() const { return capacity; }
+	long long getHits() const { return hits; }
+	long long getSuffixHits() const { return suffixHits; }
+	long long getMisses() const { return misses; }
+	float getHitRate() const { return hits + suffixHits + misses > 0 ? static_cast<float>(hits + suffixHits) / (hits + suffixHits + misses) : 0.0f; }
+	long long getEvictions() const { return evictions; }
+	long long getInvalidations() const { return invalidations; }
+	size_t getMemoryBytes() const;
+};
@@ -0,0 +1,73 @@
+#include "PathSmoother.h"
+
+std::vector<Position> PathSmoother::stringPull(const std::vector<Position>& path)
+{
+    if (path.size() < 3)
+        return path;
+
+    std::vector<Position> result = { path.front() };
+    size_t anchor = 0;
+    size_t last = path.size() - 1;
+
+    while (anchor < last) {
+        // Gallop forward to bracket the farthest visible cell, then bisect
+        size_t visible = anchor + 1;
+        size_t hidden = visible;
+        size_t step = 1;
+        while (true) {
+            size_t probe = std::min(visible + step, last);
+            if (probe == visible)
+                break;
+            if (grid.lineOfSight(path[anchor], path[probe])) {
+                visible = probe;
+                step *= 2;
+            }
+            else {
+                hidden = probe;
+                break;
+            }
+        }
+
+        while (hidden > visible + 1) {
+            size_t mid = visible + (hidden - visible) / 2;
+            if (grid.lineOfSight(path[anchor], path[mid]))
+                visible = mid;
+            else
+                hidden = mid;
+        }
+
+        result.push_back(path[visible]);
+        anchor = visible;
+    }
+    return result;
+}
+
+std::vector<Pos> PathSmoother::catmullRom(const std::vector<Position>& waypoints, int samplesPerSegment)
+{
+    std::vector<Pos> curve;
+    if (waypoints.empty())
+        return curve;
+
+    auto point = [&waypoints](size_t i) {
+        return Pos(waypoints[i].x + 0.5f, waypoints[i].y + 0.5f);
+    };
+
+    size_t last = waypoints.size() - 1;
+    curve.reserve(last * samplesPerSegment + 1);
+
+    for (size_t i = 0; i < last; ++i) {
+        Pos p0 = point(i == 0 ? i : i - 1);
+        Pos p1 = point(i);
+        Pos p2 = point(i + 1);
+        Pos p3 = point(i + 1 == last ? last : i + 2);
+
+        for (int s = 0; s < samplesPerSegment; ++s) {
+            float t = static_cast<float>(s) / samplesPerSegment;
+            float t2 = t * t;
+            float t3 = t2 * t;
+            curve.push_back(0.5f * ((2.0f * p1) + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 + (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3));
+        }
+    }
+    curve.push_back(point(last));
+    return curve;
+}
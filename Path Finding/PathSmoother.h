@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Grid.h"
+#include <vector>
+
+enum Smoothing {
+	No_Smoothing, String_Pulling, Catmull_Rom, Smoothing_Count
+};
+
+class PathSmoother
+{
+private:
+	Grid& grid;
+
+public:
+	PathSmoother(Grid& _grid) : grid(_grid) {}
+
+	// Greedy line-of-sight shortcutting, keeps only the turning points
+	std::vector<Position> stringPull(const std::vector<Position>& path);
+
+	// Curve through the waypoints in cell units (cell centres at +0.5)
+	std::vector<Pos> catmullRom(const std::vector<Position>& waypoints, int samplesPerSegment);
+};
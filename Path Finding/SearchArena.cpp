@@ -0,0 +1,28 @@
+#include "SearchArena.h"
+#include <algorithm>
+
+SearchArena::SearchArena(size_t initialBytes) : block(initialBytes)
+{
+    arena.emplace(block.data(), block.size());
+}
+
+void* SearchArena::do_allocate(size_t bytes, size_t alignment)
+{
+    usedBytes += bytes;
+    return arena->allocate(bytes, alignment);
+}
+
+void SearchArena::release()
+{
+    peakBytes = std::max(peakBytes, usedBytes);
+
+    // Outgrew the first block: replace it with one that fits the whole query
+    if (usedBytes > block.size()) {
+        arena.reset();
+        block = std::vector<std::byte>(usedBytes + usedBytes / 4);
+        arena.emplace(block.data(), block.size());
+    }
+    else
+        arena->release();
+    usedBytes = 0;
+}
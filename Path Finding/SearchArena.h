@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory_resource>
+#include <vector>
+#include <optional>
+#include <cstddef>
+
+// Monotonic arena for per-query container nodes. Allocation bumps a
+// pointer and deallocation is a no-op; release() rewinds the whole arena
+// at once. The first block grows to the largest query seen, so once warm
+// a search stays inside a single block and never calls the system heap.
+// Containers using the arena must be destroyed before it is released.
+class SearchArena : public std::pmr::memory_resource
+{
+private:
+	std::vector<std::byte> block;
+	std::optional<std::pmr::monotonic_buffer_resource> arena;
+	size_t usedBytes = 0;
+	size_t peakBytes = 0;
+
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void*, size_t, size_t) override {}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+public:
+	explicit SearchArena(size_t initialBytes = 64 * 1024);
+
+	void release();
+
+	size_t getUsedBytes() const { return usedBytes; }
+	size_t getPeakBytes() const { return peakBytes; }
+	size_t getBlockBytes() const { return block.size(); }
+};
@@ -0,0 +1,69 @@
+#include "SearchContext.h"
+#include <algorithm>
+#include <functional>
+
+void SearchContext::begin(int cells)
+{
+    if (static_cast<int>(g.size()) < cells) {
+        g.resize(cells);
+        parent.resize(cells);
+        stamp.resize(cells, 0);
+        closed.resize((cells + 63) / 64);
+    }
+    std::fill(closed.begin(), closed.begin() + (cells + 63) / 64, 0);
+    open.clear();
+
+    if (++generation == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        generation = 1;
+    }
+}
+
+void SearchContext::push(float f, int cell)
+{
+    open.emplace_back(f, cell);
+    std::push_heap(open.begin(), open.end(), std::greater<Entry>());
+}
+
+SearchContext::Entry SearchContext::pop()
+{
+    std::pop_heap(open.begin(), open.end(), std::greater<Entry>());
+    Entry top = open.back();
+    open.pop_back();
+    return top;
+}
+
+size_t SearchContext::getMemoryBytes() const
+{
+    return open.capacity() * sizeof(Entry) + closed.capacity() * sizeof(uint64_t) +
+           g.capacity() * sizeof(float) + parent.capacity() * sizeof(int) + stamp.capacity() * sizeof(unsigned int);
+}
+
+std::vector<std::unique_ptr<SearchContext>>& SearchContextPool::idle()
+{
+    thread_local std::vector<std::unique_ptr<SearchContext>> contexts;
+    return contexts;
+}
+
+SearchContext* SearchContextPool::acquire()
+{
+    auto& contexts = idle();
+    if (contexts.empty())
+        return new SearchContext();
+    SearchContext* context = contexts.back().release();
+    contexts.pop_back();
+    return context;
+}
+
+void SearchContextPool::release(SearchContext* context)
+{
+    idle().emplace_back(context);
+}
+
+size_t SearchContextPool::getMemoryBytes()
+{
+    size_t bytes = 0;
+    for (const auto& context : idle())
+        bytes += context->getMemoryBytes();
+    return bytes;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cfloat>
+#include <utility>
+
+// Scratch state of one headless grid search: a binary-heap open list,
+// a closed bitmap and per-cell g and parent arrays. Costs and parents are
+// stamped with a generation, so starting a new search only clears the
+// bitmap; once the arrays have grown to the grid, a search allocates nothing.
+class SearchContext
+{
+private:
+	typedef std::pair<float, int> Entry; // [f, cell]
+
+	std::vector<Entry> open;  // min-heap, stale entries skipped when popped
+	std::vector<uint64_t> closed;
+	std::vector<float> g;
+	std::vector<int> parent;
+	std::vector<unsigned int> stamp;
+	unsigned int generation = 0;
+
+public:
+	void begin(int cells);
+
+	float getG(int cell) const { return stamp[cell] == generation ? g[cell] : FLT_MAX; }
+	int getParent(int cell) const { return stamp[cell] == generation ? parent[cell] : -1; }
+	void setG(int cell, float cost, int from) { g[cell] = cost; parent[cell] = from; stamp[cell] = generation; }
+
+	bool isClosed(int cell) const { return (closed[cell >> 6] >> (cell & 63)) & 1u; }
+	void close(int cell) { closed[cell >> 6] |= uint64_t(1) << (cell & 63); }
+
+	bool empty() const { return open.empty(); }
+	size_t size() const { return open.size(); } // stale entries included
+	void push(float f, int cell);
+	Entry pop();
+
+	size_t getMemoryBytes() const;
+};
+
+// Per-thread free list of contexts. A lease hands one out and returns it
+// on destruction, so nested or repeated searches on a thread reuse warm
+// scratch instead of allocating.
+class SearchContextPool
+{
+private:
+	static std::vector<std::unique_ptr<SearchContext>>& idle();
+
+public:
+	static SearchContext* acquire();
+	static void release(SearchContext* context);
+	static size_t getIdleCount() { return idle().size(); }
+	static size_t getMemoryBytes(); // scratch held by this thread's idle contexts
+};
+
+class SearchContextLease
+{
+private:
+	SearchContext* context;
+
+public:
+	SearchContextLease() : context(SearchContextPool::acquire()) {}
+	~SearchContextLease() { SearchContextPool::release(context); }
+	SearchContextLease(const SearchContextLease&) = delete;
+	SearchContextLease& operator=(const SearchContextLease&) = delete;
+
+	SearchContext& operator*() const { return *context; }
+	SearchContext* operator->() const { return context; }
+};
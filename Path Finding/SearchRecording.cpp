@@ -0,0 +1,175 @@
+#include "SearchRecording.h"
+#include <algorithm>
+#include <cfloat>
+#include <queue>
+
+void SearchRecording::begin(Position dimensions, Position goal, bool fourConnected)
+{
+    cols = dimensions.x;
+    rows = dimensions.y;
+    target = goal.x * rows + goal.y;
+    fourWay = fourConnected;
+    clear();
+}
+
+void SearchRecording::clear()
+{
+    events.clear();
+    keyframes.clear();
+    found = false;
+    step = 0;
+    state.clear();
+    parent.clear();
+    overlay.clear();
+    expanded = -1;
+}
+
+void SearchRecording::apply(const Event& event)
+{
+    int cell = static_cast<int>(event.code & 0x3fffffff);
+    switch (static_cast<Kind>(event.code >> 30)) {
+    case Push:
+        state[cell] = Open;
+        parent[cell] = event.parent;
+        overlay[cell] = 1.0f;
+        break;
+    case Expand:
+    case Found:
+        state[cell] = Closed;
+        overlay[cell] = 0.0f;
+        expanded = cell;
+        break;
+    }
+}
+
+void SearchRecording::load(const Keyframe& keyframe)
+{
+    state = keyframe.state;
+    parent = keyframe.parent;
+    expanded = keyframe.expanded;
+    for (size_t cell = 0; cell < state.size(); ++cell)
+        overlay[cell] = state[cell] == Open ? 1.0f : (state[cell] == Closed ? 0.0f : FLT_MAX);
+}
+
+// Keyframes cost a byte and an int per cell, so they are spaced at least a
+// grid apart to stay within the size of the events they skip
+void SearchRecording::finish()
+{
+    size_t cells = static_cast<size_t>(cols) * rows;
+    interval = std::max<size_t>(4096, cells);
+    ++sequence;
+    found = !events.empty() && static_cast<Kind>(events.back().code >> 30) == Found;
+
+    state.assign(cells, Unseen);
+    parent.assign(cells, -1);
+    overlay.assign(cells, FLT_MAX);
+    expanded = -1;
+    keyframes.clear();
+    for (step = 0; step < events.size(); ++step) {
+        if (step % interval == 0)
+            keyframes.push_back({ state, parent, expanded });
+        apply(events[step]);
+    }
+}
+
+void SearchRecording::seek(size_t newStep)
+{
+    newStep = std::min(newStep, events.size());
+    if (keyframes.empty() || newStep == step)
+        return;
+
+    // Within the same interval and ahead of the cursor, keep going from here
+    if (newStep < step || newStep / interval != step / interval) {
+        size_t key = std::min(newStep / interval, keyframes.size() - 1);
+        load(keyframes[key]);
+        step = key * interval;
+    }
+    for (; step < newStep; ++step)
+        apply(events[step]);
+}
+
+size_t SearchRecording::getMemoryBytes() const
+{
+    size_t cells = static_cast<size_t>(cols) * rows;
+    return events.size() * sizeof(Event) + keyframes.size() * cells * (sizeof(uint8_t) + sizeof(int));
+}
+
+std::vector<Position> SearchRecording::getBranch() const
+{
+    std::vector<Position> branch;
+    for (int cell = expanded; cell != -1 && branch.size() <= parent.size(); cell = parent[cell])
+        branch.emplace_back(cell / rows, cell % rows);
+    std::reverse(branch.begin(), branch.end());
+    return branch;
+}
+
+// Dijkstra from the target with the search's own move set and costs
+void SearchRecording::costToTarget(Grid& grid, std::vector<float>& cost) const
+{
+    typedef std::pair<float, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    cost.assign(static_cast<size_t>(cols) * rows, FLT_MAX);
+    cost[target] = 0.0f;
+    open.emplace(0.0f, target);
+
+    while (!open.empty()) {
+        auto [c, cell] = open.top();
+        open.pop();
+        if (c > cost[cell])
+            continue;
+        int x = cell / rows, y = cell % rows;
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                if ((dx == 0 && dy == 0) || (fourWay && dx != 0 && dy != 0))
+                    continue;
+                int nx = x + dx, ny = y + dy;
+                if (nx < 0 || nx >= cols || ny < 0 || ny >= rows || grid.isBlocked({ nx, ny }))
+                    continue;
+                float next = c + ((dx != 0 && dy != 0) ? 1.414f : 1.0f);
+                int nextCell = nx * rows + ny;
+                if (next < cost[nextCell]) {
+                    cost[nextCell] = next;
+                    open.emplace(next, nextCell);
+                }
+            }
+        }
+    }
+}
+
+std::vector<float> SearchRecording::computeOverlay(RecordingOverlay kind, Grid& grid) const
+{
+    std::vector<float> values(static_cast<size_t>(cols) * rows, FLT_MAX);
+    if (events.empty())
+        return values;
+
+    std::vector<float> trueCost;
+    if (kind == Heuristic_Error)
+        costToTarget(grid, trueCost);
+
+    int order = 0;
+    for (const auto& event : events) {
+        int cell = static_cast<int>(event.code & 0x3fffffff);
+        Kind eventKind = static_cast<Kind>(event.code >> 30);
+        switch (kind) {
+        case Expansion_Order:
+            if (eventKind != Push && values[cell] == FLT_MAX)
+                values[cell] = static_cast<float>(order++);
+            break;
+        case G_Cost:
+            if (eventKind == Push)
+                values[cell] = event.g;
+            break;
+        case Heuristic_Error:
+            if (eventKind == Push && trueCost[cell] != FLT_MAX)
+                values[cell] = trueCost[cell] - event.h;
+            break;
+        case Reexpansion_Count:
+            if (eventKind != Push)
+                values[cell] = values[cell] == FLT_MAX ? 0.0f : values[cell] + 1.0f;
+            break;
+        default:
+            break;
+        }
+    }
+    return values;
+}
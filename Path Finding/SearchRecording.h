@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Grid.h"
+#include <vector>
+#include <cstdint>
+
+// Whole-search views computed from a recording
+enum RecordingOverlay {
+	Expansion_Order, G_Cost, Heuristic_Error, Reexpansion_Count, RecordingOverlay_Count
+};
+
+// Event log of one search, recorded at full speed and replayed afterwards.
+// Each event is 16 bytes: the cell with its kind in the top two bits, and
+// for pushes the parent and the g and h the cell was pushed with. When recording finishes, the cell states and
+// parents are snapshotted every `interval` events, so seeking to any step
+// replays at most one interval from the nearest keyframe.
+class SearchRecording
+{
+public:
+	enum CellState : uint8_t { Unseen, Open, Closed };
+
+private:
+	enum Kind : uint32_t { Push, Expand, Found };
+
+	struct Event {
+		uint32_t code; // kind << 30 | cell
+		int32_t parent;
+		float g, h;
+	};
+
+	struct Keyframe {
+		std::vector<uint8_t> state;
+		std::vector<int> parent;
+		int expanded;
+	};
+
+	int cols = 0, rows = 0;
+	int target = -1;
+	bool fourWay = false;
+	std::vector<Event> events;
+	std::vector<Keyframe> keyframes; // keyframes[k] is the state before event k * interval
+	size_t interval = 4096;
+	bool found = false;
+	unsigned int sequence = 0; // bumped by each finish()
+
+	// replay cursor
+	size_t step = 0;
+	std::vector<uint8_t> state;
+	std::vector<int> parent;
+	std::vector<float> overlay; // heatmap values: closed 0, open 1, FLT_MAX unseen
+	int expanded = -1;          // cell expanded last before the cursor
+
+	void record(Kind kind, int cell, int from, float g, float h) { events.push_back({ static_cast<uint32_t>(kind) << 30 | static_cast<uint32_t>(cell), from, g, h }); }
+	void apply(const Event& event);
+	void load(const Keyframe& keyframe);
+	void costToTarget(Grid& grid, std::vector<float>& cost) const;
+
+public:
+	void begin(Position dimensions, Position goal, bool fourConnected);
+	void clear(); // drops the log and the replay
+	void push(int cell, int from, float g, float h) { record(Push, cell, from, g, h); }
+	void expand(int cell) { record(Expand, cell, -1, 0.0f, 0.0f); }
+	void reach(int cell) { record(Found, cell, -1, 0.0f, 0.0f); }
+	void finish(); // builds the keyframes and rewinds the cursor to the end
+
+	void seek(size_t newStep);
+
+	bool isEmpty() const { return events.empty(); }
+	bool isFound() const { return found; }
+	unsigned int getSequence() const { return sequence; }
+	size_t getStep() const { return step; }
+	size_t getLength() const { return events.size(); }
+	size_t getMemoryBytes() const;
+	const std::vector<float>& getOverlay() const { return overlay; }
+	std::vector<Position> getBranch() const; // source to the last expanded cell at the cursor
+
+	// [x * rows + y] over the whole search, FLT_MAX for cells it never reached.
+	// Heuristic_Error is the true cost to the target minus h, so negative
+	// values mark where the heuristic overestimates
+	std::vector<float> computeOverlay(RecordingOverlay kind, Grid& grid) const;
+};
@@ -0,0 +1,175 @@
+#include "SparseGrid.h"
+#include <algorithm>
+#include <bit>
+
+static constexpr int chunkCells = SparseGrid::chunkSize * SparseGrid::chunkSize;
+
+const uint64_t SparseGrid::freeColumns[chunkSize] = {};
+const uint64_t SparseGrid::blockedColumns[chunkSize] = {
+    ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull,
+    ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull,
+    ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull,
+    ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull, ~0ull
+};
+
+// Rows first to last of a chunk column, inclusive
+static uint64_t rowMask(int first, int last)
+{
+    uint64_t upTo = last == SparseGrid::chunkSize - 1 ? ~0ull : (uint64_t(1) << (last + 1)) - 1;
+    return upTo & ~((uint64_t(1) << first) - 1);
+}
+
+const uint64_t* SparseGrid::chunkColumns(uint64_t key) const
+{
+    auto found = chunks.find(key);
+    if (found == chunks.end())
+        return freeColumns;
+    return found->second ? found->second->columns : blockedColumns;
+}
+
+bool SparseGrid::isBlocked(Position cell) const
+{
+    const uint64_t* columns = chunkColumns(chunkKey(cell.x >> chunkBits, cell.y >> chunkBits));
+    return (columns[cell.x & (chunkSize - 1)] >> (cell.y & (chunkSize - 1))) & 1u;
+}
+
+void SparseGrid::setBlocked(Position cell, bool blocked)
+{
+    fillRect(cell, cell, blocked);
+}
+
+void SparseGrid::fillRect(Position min, Position max, bool blocked)
+{
+    if (min.x > max.x || min.y > max.y)
+        return;
+
+    bool changed = false;
+    for (int cx = min.x >> chunkBits; cx <= max.x >> chunkBits; ++cx) {
+        for (int cy = min.y >> chunkBits; cy <= max.y >> chunkBits; ++cy) {
+            int x0 = std::max(min.x, cx * chunkSize) & (chunkSize - 1);
+            int x1 = std::min(max.x, cx * chunkSize + chunkSize - 1) & (chunkSize - 1);
+            int y0 = std::max(min.y, cy * chunkSize) & (chunkSize - 1);
+            int y1 = std::min(max.y, cy * chunkSize + chunkSize - 1) & (chunkSize - 1);
+            uint64_t key = chunkKey(cx, cy);
+            auto found = chunks.find(key);
+            bool present = found != chunks.end();
+            bool full = present && !found->second;
+            if ((!present && !blocked) || (full && blocked))
+                continue;
+            changed = true;
+
+            // Covering the whole chunk only flips its flag
+            if (x0 == 0 && y0 == 0 && x1 == chunkSize - 1 && y1 == chunkSize - 1) {
+                if (blocked) {
+                    chunks[key].reset();
+                    ++fullChunks;
+                }
+                else {
+                    fullChunks -= full;
+                    chunks.erase(found);
+                }
+                continue;
+            }
+
+            if (!present)
+                found = chunks.emplace(key, std::make_unique<Chunk>()).first;
+            else if (full) {
+                found->second = std::make_unique<Chunk>();
+                std::copy(blockedColumns, blockedColumns + chunkSize, found->second->columns);
+                found->second->blockedCells = chunkCells;
+                --fullChunks;
+            }
+
+            Chunk& chunk = *found->second;
+            uint64_t mask = rowMask(y0, y1);
+            for (int x = x0; x <= x1; ++x) {
+                uint64_t before = chunk.columns[x];
+                chunk.columns[x] = blocked ? before | mask : before & ~mask;
+                chunk.blockedCells += std::popcount(chunk.columns[x]) - std::popcount(before);
+            }
+            if (chunk.blockedCells == 0)
+                chunks.erase(found);
+            else if (chunk.blockedCells == chunkCells) {
+                found->second.reset();
+                ++fullChunks;
+            }
+        }
+    }
+    if (changed)
+        ++version;
+}
+
+void SparseGrid::clear()
+{
+    chunks.clear();
+    fullChunks = 0;
+    ++version;
+}
+
+void SparseGrid::draw(sf::RenderTarget& target, Position origin, Position extent, float cellSize, sf::Color color) const
+{
+    if (extent.x <= 0 || extent.y <= 0)
+        return;
+
+    Position last = origin + extent - Position(1, 1);
+    int cx0 = origin.x >> chunkBits, cx1 = last.x >> chunkBits;
+    int cy0 = origin.y >> chunkBits, cy1 = last.y >> chunkBits;
+
+    sf::VertexArray quads(sf::Quads);
+    auto addQuad = [&](int x, int y, int width, int height) {
+        Pos corner(static_cast<float>(x - origin.x) * cellSize, static_cast<float>(y - origin.y) * cellSize);
+        Pos size(width * cellSize, height * cellSize);
+        quads.append(sf::Vertex(corner, color));
+        quads.append(sf::Vertex(corner + Pos(size.x, 0.0f), color));
+        quads.append(sf::Vertex(corner + size, color));
+        quads.append(sf::Vertex(corner + Pos(0.0f, size.y), color));
+    };
+
+    // Clipped to the view; full chunks as one quad, mixed ones as one quad per vertical run
+    auto drawChunk = [&](Position chunk, const Chunk* cells) {
+        int x0 = std::max(origin.x, chunk.x * chunkSize), x1 = std::min(last.x, chunk.x * chunkSize + chunkSize - 1);
+        int y0 = std::max(origin.y, chunk.y * chunkSize), y1 = std::min(last.y, chunk.y * chunkSize + chunkSize - 1);
+        if (!cells) {
+            addQuad(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+            return;
+        }
+        uint64_t visible = rowMask(y0 & (chunkSize - 1), y1 & (chunkSize - 1));
+        for (int x = x0; x <= x1; ++x) {
+            uint64_t column = cells->columns[x & (chunkSize - 1)] & visible;
+            while (column) {
+                int start = std::countr_zero(column);
+                int length = std::countr_one(column >> start);
+                addQuad(x, chunk.y * chunkSize + start, 1, length);
+                column &= ~rowMask(start, start + length - 1);
+            }
+        }
+    };
+
+    // Walk whichever is smaller: the chunks in view or the chunks stored
+    long long inView = static_cast<long long>(cx1 - cx0 + 1) * (cy1 - cy0 + 1);
+    if (inView <= static_cast<long long>(chunks.size())) {
+        for (int cx = cx0; cx <= cx1; ++cx)
+            for (int cy = cy0; cy <= cy1; ++cy) {
+                auto found = chunks.find(chunkKey(cx, cy));
+                if (found != chunks.end())
+                    drawChunk({ cx, cy }, found->second.get());
+            }
+    }
+    else {
+        for (const auto& [key, cells] : chunks) {
+            Position chunk = chunkOf(key);
+            if (chunk.x >= cx0 && chunk.x <= cx1 && chunk.y >= cy0 && chunk.y <= cy1)
+                drawChunk(chunk, cells.get());
+        }
+    }
+    target.draw(quads);
+}
+
+// Map nodes and bucket array approximated from the standard layout
+size_t SparseGrid::getMemoryBytes() const
+{
+    size_t bytes = chunks.bucket_count() * sizeof(void*);
+    bytes += chunks.size() * (sizeof(std::pair<const uint64_t, std::unique_ptr<Chunk>>) + sizeof(void*) + sizeof(size_t));
+    bytes += (chunks.size() - fullChunks) * sizeof(Chunk);
+    return bytes;
+}
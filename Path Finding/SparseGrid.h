@@ -0,0 +1,94 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include "Node.h"
+#include <unordered_map>
+#include <memory>
+#include <cstdint>
+
+// Blocked cells of an effectively unbounded world, in 64 x 64 chunks that
+// exist only where the world is mixed. A chunk with nothing blocked is not
+// stored at all and a chunk blocked throughout is stored as a flag, so
+// memory follows the occupied area rather than the extent of the world.
+// Cells are bit-packed like Wavefront: bit y of column x of the chunk.
+class SparseGrid
+{
+public:
+	static constexpr int chunkBits = 6;
+	static constexpr int chunkSize = 1 << chunkBits; // cells per chunk side
+
+	// Reads cells through a few cached chunk pointers; a walk over nearby
+	// cells rarely touches the chunk map. Any edit of the grid flushes it.
+	class Reader
+	{
+	private:
+		static constexpr int slotCount = 8; // direct mapped by chunk key
+
+		struct Slot {
+			uint64_t key = ~uint64_t(0);
+			const uint64_t* columns = nullptr;
+		};
+
+		const SparseGrid& grid;
+		unsigned int version;
+		Slot slots[slotCount];
+		long long hits = 0, misses = 0;
+
+	public:
+		explicit Reader(const SparseGrid& _grid) : grid(_grid), version(_grid.version) {}
+
+		bool isBlocked(Position cell) {
+			uint64_t key = chunkKey(cell.x >> chunkBits, cell.y >> chunkBits);
+			if (version != grid.version) {
+				for (Slot& slot : slots)
+					slot = Slot();
+				version = grid.version;
+			}
+			Slot& slot = slots[(key ^ key >> 29) % slotCount];
+			if (slot.key == key)
+				++hits;
+			else {
+				++misses;
+				slot.key = key;
+				slot.columns = grid.chunkColumns(key);
+			}
+			return (slot.columns[cell.x & (chunkSize - 1)] >> (cell.y & (chunkSize - 1))) & 1u;
+		}
+
+		long long getHits() const { return hits; }
+		long long getMisses() const { return misses; }
+	};
+
+private:
+	struct Chunk {
+		uint64_t columns[chunkSize] = {};
+		int blockedCells = 0;
+	};
+
+	// A null chunk is blocked throughout; an absent one is free throughout
+	std::unordered_map<uint64_t, std::unique_ptr<Chunk>> chunks;
+	int fullChunks = 0;
+	unsigned int version = 0; // bumped on every edit
+
+	static const uint64_t freeColumns[chunkSize];
+	static const uint64_t blockedColumns[chunkSize];
+
+	static uint64_t chunkKey(int cx, int cy) { return static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32 | static_cast<uint32_t>(cy); }
+	static Position chunkOf(uint64_t key) { return { static_cast<int>(key >> 32), static_cast<int>(static_cast<uint32_t>(key)) }; }
+	const uint64_t* chunkColumns(uint64_t key) const;
+
+public:
+	bool isBlocked(Position cell) const;
+	void setBlocked(Position cell, bool blocked);
+	void fillRect(Position min, Position max, bool blocked); // inclusive; whole chunks become flags
+	void clear();
+
+	// Only the chunks overlapping the view are visited; free ones draw nothing
+	// and full ones a single quad. Cells are drawn at (cell - origin) * cellSize.
+	void draw(sf::RenderTarget& target, Position origin, Position extent, float cellSize, sf::Color color) const;
+
+	unsigned int getVersion() const { return version; }
+	size_t getChunkCount() const { return chunks.size(); }
+	int getFullChunks() const { return fullChunks; }
+	size_t getMemoryBytes() const;
+};
@@ -0,0 +1,91 @@
+#include "SparseSearch.h"
+#include <chrono>
+#include <algorithm>
+#include <functional>
+
+// In thousandths of a step, matching the grid's 1 and 1.414
+static int64_t octile(Position a, Position b)
+{
+    int64_t dx = std::abs(static_cast<int64_t>(a.x) - b.x);
+    int64_t dy = std::abs(static_cast<int64_t>(a.y) - b.y);
+    return 1414 * std::min(dx, dy) + 1000 * std::abs(dx - dy);
+}
+
+SearchResult SparseSearch::query(Position source, Position target)
+{
+    auto start = std::chrono::steady_clock::now();
+    SearchResult result;
+    SparseGrid::Reader reader(world);
+    records.clear();
+    open.clear();
+    expansions = 0;
+
+    auto finish = [&]() {
+        timeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        result.timeMs = timeMs;
+        result.expansions = expansions;
+        long long reads = reader.getHits() + reader.getMisses();
+        readerHitRate = reads > 0 ? static_cast<double>(reader.getHits()) / reads : 0.0;
+        return result;
+    };
+
+    if (reader.isBlocked(source)) {
+        result.error = NoSourceNode;
+        return finish();
+    }
+    if (reader.isBlocked(target)) {
+        result.error = NoTargetNode;
+        return finish();
+    }
+
+    // Open ground has wide bands of equal f; deeper entries first keeps to one path through them
+    auto greater = std::greater<std::tuple<int64_t, int64_t, uint64_t>>();
+    records[key(source)] = { 0, key(source), false };
+    open.emplace_back(octile(source, target), 0, key(source));
+
+    while (!open.empty() && expansions < maxExpansions) {
+        std::pop_heap(open.begin(), open.end(), greater);
+        uint64_t cell = std::get<2>(open.back());
+        open.pop_back();
+
+        Record& record = records[cell];
+        if (record.closed)
+            continue;
+        record.closed = true;
+        ++expansions;
+
+        Position pos = position(cell);
+        if (pos == target) {
+            result.cost = static_cast<float>(record.g / 1000.0);
+            for (uint64_t k = cell; ; k = records[k].parent) {
+                result.waypoints.push_back(position(k));
+                if (k == key(source))
+                    break;
+            }
+            std::reverse(result.waypoints.begin(), result.waypoints.end());
+            return finish();
+        }
+
+        int64_t g = record.g;
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                Position next(pos.x + dx, pos.y + dy);
+                if ((dx == 0 && dy == 0) || reader.isBlocked(next))
+                    continue;
+                int64_t nextG = g + ((dx != 0 && dy != 0) ? 1414 : 1000);
+                auto [slot, fresh] = records.try_emplace(key(next), Record{ nextG, cell, false });
+                if (!fresh) {
+                    if (slot->second.closed || slot->second.g <= nextG)
+                        continue;
+                    slot->second.g = nextG;
+                    slot->second.parent = cell;
+                }
+                open.emplace_back(nextG + octile(next, target), -nextG, key(next));
+                std::push_heap(open.begin(), open.end(), greater);
+            }
+        }
+    }
+
+    result.error = NoPath;
+    return finish();
+}
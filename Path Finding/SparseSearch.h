@@ -0,0 +1,47 @@
+#pragma once
+
+#include "SparseGrid.h"
+#include "Astar.h"
+#include <vector>
+#include <unordered_map>
+#include <tuple>
+#include <cstdint>
+
+// A* over a SparseGrid, 8-connected with corner cutting like the editor
+// grid. The world has no edges, so per-cell state lives in a hash map sized
+// by what the search touches, and an unreachable target ends the search
+// at the expansion limit. Cells are read through a SparseGrid::Reader.
+class SparseSearch
+{
+private:
+	struct Record {
+		int64_t g; // thousandths, so equal-cost paths tie exactly
+		uint64_t parent;
+		bool closed;
+	};
+
+	SparseGrid& world;
+	int maxExpansions = 1 << 20;
+
+	std::unordered_map<uint64_t, Record> records;
+	std::vector<std::tuple<int64_t, int64_t, uint64_t>> open; // [f, -g, cell], a min-heap; deeper first on ties
+
+	int expansions = 0;
+	float timeMs = 0.0f;
+	double readerHitRate = 0.0;
+
+	static uint64_t key(Position p) { return static_cast<uint64_t>(static_cast<uint32_t>(p.x)) << 32 | static_cast<uint32_t>(p.y); }
+	static Position position(uint64_t k) { return { static_cast<int>(k >> 32), static_cast<int>(static_cast<uint32_t>(k)) }; }
+
+public:
+	SparseSearch(SparseGrid& _world) : world(_world) {}
+
+	void setMaxExpansions(int newMax) { maxExpansions = newMax; }
+	SearchResult query(Position source, Position target);
+
+	int getMaxExpansions() const { return maxExpansions; }
+	int getExpansions() const { return expansions; }
+	float getTimeMs() const { return timeMs; }
+	size_t getTouchedCells() const { return records.size(); }
+	double getReaderHitRate() const { return readerHitRate; }
+};
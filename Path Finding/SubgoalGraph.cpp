@@ -0,0 +1,426 @@
+#include "SubgoalGraph.h"
+#include <chrono>
+#include <algorithm>
+#include <functional>
+
+typedef std::pair<float, int> HeapEntry; // [f, node]
+
+static void heapPush(std::vector<HeapEntry>& heap, float key, int node)
+{
+    heap.emplace_back(key, node);
+    std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+}
+
+static HeapEntry heapPop(std::vector<HeapEntry>& heap)
+{
+    std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+    HeapEntry top = heap.back();
+    heap.pop_back();
+    return top;
+}
+
+// Larger batches of edits are cheaper to handle with a full rebuild
+static const size_t maxIncrementalEdits = 64;
+
+float SubgoalGraph::octile(Position a, Position b) const
+{
+    int dx = std::abs(a.x - b.x);
+    int dy = std::abs(a.y - b.y);
+    return 1.414f * std::min(dx, dy) + static_cast<float>(std::abs(dx - dy));
+}
+
+// A free cell beside a blocked cell that ends a wall: paths around that end bend here.
+// Diagonal steps may cut corners, so only the orthogonal neighbour matters.
+bool SubgoalGraph::qualifies(Position cell) const
+{
+    if (!isFree(cell.x, cell.y))
+        return false;
+
+    const Position orthogonal[4] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+    for (const auto& o : orthogonal) {
+        Position wall = cell + o;
+        if (wall.x < 0 || wall.x >= cols || wall.y < 0 || wall.y >= rows || !blocked[index(wall)])
+            continue;
+        Position side(o.y, o.x);
+        if (isFree(wall.x + side.x, wall.y + side.y) || isFree(wall.x - side.x, wall.y - side.y))
+            return true;
+    }
+    return false;
+}
+
+int SubgoalGraph::addSubgoal(Position cell)
+{
+    int id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+    }
+    else {
+        id = static_cast<int>(subgoalCell.size());
+        subgoalCell.emplace_back();
+        edges.emplace_back();
+    }
+    subgoalId[index(cell)] = id;
+    subgoalCell[id] = cell;
+    ++subgoals;
+    return id;
+}
+
+void SubgoalGraph::removeSubgoal(int id)
+{
+    disconnect(id);
+    subgoalId[index(subgoalCell[id])] = -1;
+    subgoalCell[id] = { -1, -1 };
+    freeIds.push_back(id);
+    --subgoals;
+}
+
+void SubgoalGraph::connect(int a, int b, float cost)
+{
+    edges[a].push_back({ b, cost });
+    edges[b].push_back({ a, cost });
+    ++edgeCount;
+}
+
+void SubgoalGraph::disconnect(int id)
+{
+    for (const auto& edge : edges[id]) {
+        auto& back = edges[edge.to];
+        back.erase(std::remove_if(back.begin(), back.end(), [id](const Edge& e) { return e.to == id; }), back.end());
+    }
+    edgeCount -= static_cast<int>(edges[id].size());
+    edges[id].clear();
+}
+
+// Collects the subgoals (and stopCell) reachable from a cell along an octile-length path
+// that passes no other subgoal. Such a path only uses one diagonal and one neighbouring
+// cardinal direction, so each of the eight cones is flooded separately.
+void SubgoalGraph::scan(Position from, int stopCell, std::vector<int>& cells)
+{
+    cells.clear();
+    ++foundStamp;
+
+    for (int dx = -1; dx <= 1; dx += 2) {
+        for (int dy = -1; dy <= 1; dy += 2) {
+            Position diagonal(dx, dy);
+            for (Position cardinal : { Position(dx, 0), Position(0, dy) }) {
+                ++visitStamp;
+                stack.assign(1, index(from));
+                while (!stack.empty()) {
+                    Position pos = position(stack.back());
+                    stack.pop_back();
+
+                    for (Position move : { cardinal, diagonal }) {
+                        Position next = pos + move;
+                        if (!isFree(next.x, next.y))
+                            continue;
+
+                        int cell = index(next);
+                        if (visited[cell] == visitStamp)
+                            continue;
+                        visited[cell] = visitStamp;
+
+                        if (subgoalId[cell] != -1 || cell == stopCell) {
+                            if (found[cell] != foundStamp) {
+                                found[cell] = foundStamp;
+                                cells.push_back(cell);
+                            }
+                            continue;
+                        }
+                        stack.push_back(cell);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Appends the cells after from up to and including to, along an octile-length path
+void SubgoalGraph::unpack(Position from, Position to, std::vector<Position>& path)
+{
+    Position delta = to - from;
+    Position diagonal((delta.x > 0) - (delta.x < 0), (delta.y > 0) - (delta.y < 0));
+    Position cardinal = std::abs(delta.x) >= std::abs(delta.y) ? Position(diagonal.x, 0) : Position(0, diagonal.y);
+    int minX = std::min(from.x, to.x), maxX = std::max(from.x, to.x);
+    int minY = std::min(from.y, to.y), maxY = std::max(from.y, to.y);
+
+    ++visitStamp;
+    int goal = index(to);
+    stack.assign(1, index(from));
+    visited[index(from)] = visitStamp;
+    while (!stack.empty() && visited[goal] != visitStamp) {
+        int cell = stack.back();
+        stack.pop_back();
+        Position pos = position(cell);
+
+        for (Position move : { diagonal, cardinal }) {
+            Position next = pos + move;
+            if (next.x < minX || next.x > maxX || next.y < minY || next.y > maxY || !isFree(next.x, next.y))
+                continue;
+            int nextCell = index(next);
+            if (visited[nextCell] == visitStamp)
+                continue;
+            visited[nextCell] = visitStamp;
+            parentCell[nextCell] = cell;
+            stack.push_back(nextCell);
+        }
+    }
+
+    size_t first = path.size();
+    for (int cell = goal; cell != index(from); cell = parentCell[cell])
+        path.push_back(position(cell));
+    std::reverse(path.begin() + first, path.end());
+}
+
+void SubgoalGraph::build()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    Position dim = grid.getDimensions();
+    cols = dim.x;
+    rows = dim.y;
+    int cells = cols * rows;
+    blocked = grid.getBlockedMask();
+
+    subgoalId.assign(cells, -1);
+    subgoalCell.clear();
+    edges.clear();
+    freeIds.clear();
+    subgoals = 0;
+    edgeCount = 0;
+
+    visited.assign(cells, 0);
+    found.assign(cells, 0);
+    parentCell.assign(cells, -1);
+    visitStamp = foundStamp = 0;
+    gCost.clear();
+    parent.clear();
+    targetLink.clear();
+    touched.clear();
+
+    for (int x = 0; x < cols; ++x)
+        for (int y = 0; y < rows; ++y)
+            if (qualifies({ x, y }))
+                addSubgoal({ x, y });
+
+    // Reachability is symmetric, so each pair is added from its lower id
+    std::vector<int> reached;
+    for (int id = 0; id < static_cast<int>(subgoalCell.size()); ++id) {
+        scan(subgoalCell[id], -1, reached);
+        for (int cell : reached) {
+            int other = subgoalId[cell];
+            if (other > id)
+                connect(id, other, octile(subgoalCell[id], subgoalCell[other]));
+        }
+    }
+
+    builtVersion = grid.getVersion();
+    built = true;
+    buildMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Only cells within one of an edit can change status, and a subgoal's edges can only
+// change if it reaches one of those cells; reachability is symmetric, so scanning
+// from each of them finds exactly the subgoals to redo
+void SubgoalGraph::applyEdits(const std::vector<Position>& cells)
+{
+    for (const auto& cell : cells)
+        blocked[index(cell)] = grid.isBlocked(cell);
+
+    std::vector<int> dirty;
+    for (const auto& cell : cells) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                Position near = cell + Position(dx, dy);
+                if (near.x < 0 || near.x >= cols || near.y < 0 || near.y >= rows)
+                    continue;
+                int id = subgoalId[index(near)];
+                bool wanted = qualifies(near);
+                if (wanted && id == -1)
+                    dirty.push_back(addSubgoal(near));
+                else if (!wanted && id != -1)
+                    removeSubgoal(id);
+            }
+        }
+    }
+
+    std::vector<uint8_t> isDirty(subgoalCell.size(), 0);
+    for (int id : dirty)
+        isDirty[id] = 1;
+
+    std::vector<int> reached;
+    for (const auto& cell : cells) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                Position near = cell + Position(dx, dy);
+                if (near.x < 0 || near.x >= cols || near.y < 0 || near.y >= rows)
+                    continue;
+                scan(near, -1, reached);
+                for (int other : reached) {
+                    int id = subgoalId[other];
+                    if (!isDirty[id]) {
+                        isDirty[id] = 1;
+                        dirty.push_back(id);
+                    }
+                }
+            }
+        }
+    }
+
+    // Drop every edge touching a dirty subgoal, filtering each neighbour list once
+    std::vector<int> neighbours;
+    for (int id : dirty) {
+        for (const auto& edge : edges[id]) {
+            if (isDirty[edge.to] == 0) {
+                isDirty[edge.to] = 2;
+                neighbours.push_back(edge.to);
+            }
+        }
+    }
+    for (int id : neighbours) {
+        auto& list = edges[id];
+        list.erase(std::remove_if(list.begin(), list.end(), [&](const Edge& e) { return isDirty[e.to] == 1; }), list.end());
+        isDirty[id] = 0;
+    }
+    for (int id : dirty) {
+        for (const auto& edge : edges[id])
+            if (!isDirty[edge.to] || edge.to > id)
+                --edgeCount;
+        edges[id].clear();
+    }
+
+    for (int id : dirty) {
+        scan(subgoalCell[id], -1, reached);
+        for (int cell : reached) {
+            int other = subgoalId[cell];
+            if (!isDirty[other] || other > id)
+                connect(id, other, octile(subgoalCell[id], subgoalCell[other]));
+        }
+    }
+    updatedSubgoals = static_cast<int>(dirty.size());
+}
+
+void SubgoalGraph::update()
+{
+    if (!built || builtVersion == grid.getVersion())
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Position> cells;
+    if (grid.getDimensions() != Position(cols, rows) || !grid.getEditsSince(builtVersion, cells) || cells.size() > maxIncrementalEdits) {
+        build();
+        updatedSubgoals = subgoals;
+    }
+    else {
+        applyEdits(cells);
+        builtVersion = grid.getVersion();
+    }
+    updateUs = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+SearchResult SubgoalGraph::query(Position source, Position target)
+{
+    auto start = std::chrono::steady_clock::now();
+    SearchResult result;
+
+    if (!built) {
+        result.error = Unknown;
+        return result;
+    }
+    if (source == Position(-1, -1)) {
+        result.error = NoSourceNode;
+        return result;
+    }
+    if (target == Position(-1, -1)) {
+        result.error = NoTargetNode;
+        return result;
+    }
+    update();
+    if (source == target) {
+        result.waypoints.push_back(source);
+        result.timeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    // Subgoal ids, then the source and target as temporary nodes
+    int nodes = static_cast<int>(subgoalCell.size());
+    int sourceNode = nodes, targetNode = nodes + 1;
+    gCost.resize(nodes + 2, FLT_MAX);
+    parent.resize(nodes + 2, -1);
+    targetLink.resize(nodes + 2, FLT_MAX);
+
+    std::vector<int> sourceCells, targetCells;
+    scan(source, index(target), sourceCells);
+    scan(target, -1, targetCells);
+    for (int cell : targetCells) {
+        int id = subgoalId[cell];
+        targetLink[id] = octile(subgoalCell[id], target);
+        touched.push_back(id);
+    }
+    if (subgoalId[index(target)] != -1) {
+        targetLink[subgoalId[index(target)]] = 0.0f;
+        touched.push_back(subgoalId[index(target)]);
+    }
+
+    auto cellOf = [&](int node) { return node == sourceNode ? source : node == targetNode ? target : subgoalCell[node]; };
+    std::vector<HeapEntry> open;
+    auto relax = [&](int from, int to, float cost) {
+        float gnew = gCost[from] + cost;
+        if (gnew >= gCost[to])
+            return;
+        gCost[to] = gnew;
+        parent[to] = from;
+        touched.push_back(to);
+        heapPush(open, gnew + octile(cellOf(to), target), to);
+    };
+
+    gCost[sourceNode] = 0.0f;
+    touched.push_back(sourceNode);
+    heapPush(open, octile(source, target), sourceNode);
+    while (!open.empty()) {
+        auto [f, node] = heapPop(open);
+        if (node == targetNode)
+            break;
+        if (f > gCost[node] + octile(cellOf(node), target))
+            continue;
+        ++result.expansions;
+
+        if (node == sourceNode) {
+            for (int cell : sourceCells) {
+                Position pos = position(cell);
+                relax(node, cell == index(target) ? targetNode : subgoalId[cell], octile(source, pos));
+            }
+            continue;
+        }
+        for (const auto& edge : edges[node])
+            relax(node, edge.to, edge.cost);
+        if (targetLink[node] != FLT_MAX)
+            relax(node, targetNode, targetLink[node]);
+    }
+
+    if (gCost[targetNode] == FLT_MAX) {
+        result.error = NoPath;
+    }
+    else {
+        std::vector<int> chain;
+        for (int node = targetNode; node != sourceNode; node = parent[node])
+            chain.push_back(node);
+        chain.push_back(sourceNode);
+        std::reverse(chain.begin(), chain.end());
+
+        result.waypoints.push_back(source);
+        for (size_t i = 1; i < chain.size(); ++i)
+            unpack(cellOf(chain[i - 1]), cellOf(chain[i]), result.waypoints);
+        result.cost = gCost[targetNode];
+    }
+
+    for (int node : touched) {
+        gCost[node] = FLT_MAX;
+        parent[node] = -1;
+        targetLink[node] = FLT_MAX;
+    }
+    touched.clear();
+
+    result.timeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
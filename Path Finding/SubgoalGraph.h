@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Grid.h"
+#include "Astar.h"
+#include <vector>
+#include <cstdint>
+
+// Simple subgoal graph over the 8-connected free cells of a Grid.
+// Subgoals are the free cells next to the end of a wall, where shortest
+// paths have to bend; edges join subgoals that are reachable along an
+// octile-length path without passing another subgoal. Queries connect the
+// source and target to the graph and search that instead of the grid.
+// Grid edits are applied locally through the grid's edit log.
+class SubgoalGraph
+{
+private:
+	struct Edge {
+		int to;     // subgoal id
+		float cost; // octile distance
+	};
+
+	Grid& grid;
+	int cols = 0, rows = 0;
+	unsigned int builtVersion = 0;
+	bool built = false;
+
+	std::vector<uint8_t> blocked;
+	std::vector<int> subgoalId;           // per cell, -1 if not a subgoal
+	std::vector<Position> subgoalCell;    // per id, {-1, -1} once freed
+	std::vector<std::vector<Edge>> edges; // per id, undirected
+	std::vector<int> freeIds;
+	int subgoals = 0;
+	int edgeCount = 0;
+
+	float buildMs = 0.0f;
+	float updateUs = 0.0f;
+	int updatedSubgoals = 0;
+
+	// scan scratch, stamped so nothing is cleared between scans
+	std::vector<unsigned int> visited;
+	std::vector<unsigned int> found;
+	unsigned int visitStamp = 0, foundStamp = 0;
+	std::vector<int> stack;
+	std::vector<int> parentCell;
+
+	// query scratch, reset through the touched list
+	std::vector<float> gCost;
+	std::vector<int> parent;
+	std::vector<float> targetLink;
+	std::vector<int> touched;
+
+	int index(Position p) const { return p.x * rows + p.y; }
+	Position position(int cell) const { return { cell / rows, cell % rows }; }
+	bool isFree(int x, int y) const { return x >= 0 && x < cols && y >= 0 && y < rows && !blocked[x * rows + y]; }
+	float octile(Position a, Position b) const;
+
+	bool qualifies(Position cell) const;
+	int addSubgoal(Position cell);
+	void removeSubgoal(int id);
+	void connect(int a, int b, float cost);
+	void disconnect(int id);
+	void scan(Position from, int stopCell, std::vector<int>& cells);
+	void unpack(Position from, Position to, std::vector<Position>& path);
+	void applyEdits(const std::vector<Position>& cells);
+
+public:
+	SubgoalGraph(Grid& _grid) : grid(_grid) {}
+
+	void build();
+	void update(); // catches up with grid edits, rebuilding only if the log is gone
+	bool isBuilt() const { return built; }
+	bool isValid() const { return built && builtVersion == grid.getVersion(); }
+
+	SearchResult query(Position source, Position target);
+
+	int getSubgoals() const { return subgoals; }
+	int getEdges() const { return edgeCount; }
+	float getBuildMs() const { return buildMs; }
+	float getUpdateUs() const { return updateUs; }
+	int getUpdatedSubgoals() const { return updatedSubgoals; }
+};
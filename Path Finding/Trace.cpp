@@ -0,0 +1,82 @@
+#include "Trace.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+std::atomic<bool> Trace::enabled{ false };
+std::atomic<uint64_t> Trace::next{ 0 };
+TraceEvent Trace::events[Trace::Capacity];
+
+// Small per-thread ids read better in the viewer than hashed thread ids
+static uint32_t threadId()
+{
+    static std::atomic<uint32_t> nextThread{ 1 };
+    thread_local uint32_t id = nextThread.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+int64_t Trace::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Trace::record(const char* name, int64_t startNs, int64_t endNs)
+{
+    uint64_t slot = next.fetch_add(1, std::memory_order_relaxed);
+    TraceEvent& event = events[slot & (Capacity - 1)];
+    event.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.name = name;
+    event.thread = threadId();
+    event.startNs = startNs;
+    event.durationNs = endNs - startNs;
+    event.sequence.store(slot + 1, std::memory_order_release);
+}
+
+void Trace::clear()
+{
+    next.store(0, std::memory_order_relaxed);
+    for (auto& event : events)
+        event.sequence.store(0, std::memory_order_relaxed);
+}
+
+// Complete ("X") events with microsecond times relative to the earliest span;
+// slots still being written are skipped
+bool Trace::writeJson(const std::string& path)
+{
+    std::ofstream out(path);
+    if (!out)
+        return false;
+
+    struct Span {
+        const char* name;
+        uint32_t thread;
+        int64_t startNs, durationNs;
+    };
+    std::vector<Span> spans;
+    uint64_t end = next.load(std::memory_order_acquire);
+    for (uint64_t slot = end > Capacity ? end - Capacity : 0; slot < end; ++slot) {
+        const TraceEvent& event = events[slot & (Capacity - 1)];
+        if (event.sequence.load(std::memory_order_acquire) != slot + 1)
+            continue;
+        Span span = { event.name, event.thread, event.startNs, event.durationNs };
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (event.sequence.load(std::memory_order_relaxed) == slot + 1)
+            spans.push_back(span);
+    }
+
+    int64_t origin = 0;
+    if (!spans.empty())
+        origin = std::min_element(spans.begin(), spans.end(), [](const Span& a, const Span& b) { return a.startNs < b.startNs; })->startNs;
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < spans.size(); ++i) {
+        const Span& span = spans[i];
+        out << (i ? "," : "") << "\n{\"name\":\"" << span.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << span.thread
+            << ",\"ts\":" << (span.startNs - origin) / 1000.0 << ",\"dur\":" << span.durationNs / 1000.0 << "}";
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+// Timeline spans recorded into a fixed ring and written out as Chrome
+// trace-event JSON, for chrome://tracing or ui.perfetto.dev. Writers
+// claim slots with one atomic increment and publish them through a
+// per-slot sequence, so recording never locks; the oldest spans are
+// overwritten once the ring is full. While tracing is off a span costs
+// a single relaxed load and branch.
+struct TraceEvent {
+	std::atomic<uint64_t> sequence{ 0 }; // slot + 1 once written, 0 while being written
+	const char* name = nullptr;           // string literal, never freed
+	uint32_t thread = 0;
+	int64_t startNs = 0;
+	int64_t durationNs = 0;
+};
+
+class Trace
+{
+private:
+	static constexpr uint64_t Capacity = 1 << 16;
+
+	static std::atomic<bool> enabled;
+	static std::atomic<uint64_t> next;
+	static TraceEvent events[Capacity];
+
+public:
+	static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+	static void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+
+	static int64_t now();
+	static void record(const char* name, int64_t startNs, int64_t endNs);
+	static void clear();
+	static bool writeJson(const std::string& path);
+
+	static uint64_t getCount() { return std::min(next.load(std::memory_order_relaxed), Capacity); }
+};
+
+class TraceSpan
+{
+private:
+	const char* name;
+	int64_t start = 0;
+
+public:
+	explicit TraceSpan(const char* _name) : name(Trace::isEnabled() ? _name : nullptr) {
+		if (name)
+			start = Trace::now();
+	}
+	~TraceSpan() {
+		if (name)
+			Trace::record(name, start, Trace::now());
+	}
+	TraceSpan(const TraceSpan&) = delete;
+	TraceSpan& operator=(const TraceSpan&) = delete;
+};
@@ -0,0 +1,164 @@
+#include "Wavefront.h"
+#include <chrono>
+#include <algorithm>
+#include <bit>
+
+// Repacks the blocked mask whenever the grid changed since the last flood
+void Wavefront::load()
+{
+    if (loaded && loadedVersion == grid.getVersion() && grid.getDimensions() == Position(cols, rows))
+        return;
+
+    Position dim = grid.getDimensions();
+    cols = dim.x;
+    rows = dim.y;
+    words = (cols + 63) / 64;
+    std::vector<uint8_t> blocked = grid.getBlockedMask();
+
+    passable.assign(rows * words, 0);
+    for (int x = 0; x < cols; ++x)
+        for (int y = 0; y < rows; ++y)
+            if (!blocked[x * rows + y])
+                passable[y * words + x / 64] |= uint64_t(1) << (x % 64);
+
+    reached.assign(rows * words, 0);
+    frontier.assign(rows * words, 0);
+    next.assign(rows * words, 0);
+    distance.assign(cols * rows, FLT_MAX);
+    loadedVersion = grid.getVersion();
+    loaded = true;
+}
+
+// Grows the wavefront layer by layer until it dies out or reaches stop
+bool Wavefront::flood(Position source, Position stop, bool withDistances)
+{
+    load();
+    std::fill(reached.begin(), reached.end(), 0);
+    std::fill(frontier.begin(), frontier.end(), 0);
+    if (withDistances)
+        std::fill(distance.begin(), distance.end(), FLT_MAX);
+    layers = 0;
+    reachedCells = 0;
+    if (source.x < 0 || source.x >= cols || source.y < 0 || source.y >= rows)
+        return false;
+
+    uint64_t sourceBit = uint64_t(1) << (source.x % 64);
+    frontier[source.y * words + source.x / 64] = sourceBit;
+    reached[source.y * words + source.x / 64] = sourceBit;
+    if (withDistances)
+        distance[source.x * rows + source.y] = 0.0f;
+    reachedCells = 1;
+
+    bool stopping = stop != Position(-1, -1);
+    int lo = source.y, hi = source.y; // rows the frontier spans
+    while (lo <= hi) {
+        if (stopping && isReachable(stop))
+            return true;
+        ++layers;
+
+        int nextLo = std::max(lo - 1, 0), nextHi = std::min(hi + 1, rows - 1);
+        int firstLive = rows, lastLive = -1;
+        for (int y = nextLo; y <= nextHi; ++y) {
+            const uint64_t* row = &frontier[y * words];
+            const uint64_t* above = y > 0 ? &frontier[(y - 1) * words] : nullptr;
+            const uint64_t* below = y + 1 < rows ? &frontier[(y + 1) * words] : nullptr;
+            bool live = false;
+
+            for (int w = 0; w < words; ++w) {
+                uint64_t f = row[w];
+                uint64_t grown = (f << 1) | (f >> 1);
+                if (w > 0)
+                    grown |= row[w - 1] >> 63;
+                if (w + 1 < words)
+                    grown |= row[w + 1] << 63;
+                if (above)
+                    grown |= above[w];
+                if (below)
+                    grown |= below[w];
+
+                uint64_t fresh = grown & passable[y * words + w] & ~reached[y * words + w];
+                next[y * words + w] = fresh;
+                if (!fresh)
+                    continue;
+
+                live = true;
+                reached[y * words + w] |= fresh;
+                reachedCells += std::popcount(fresh);
+                if (withDistances) {
+                    for (uint64_t bits = fresh; bits; bits &= bits - 1) {
+                        int x = w * 64 + std::countr_zero(bits);
+                        distance[x * rows + y] = static_cast<float>(layers);
+                    }
+                }
+            }
+            if (live) {
+                firstLive = std::min(firstLive, y);
+                lastLive = y;
+            }
+        }
+
+        // The old frontier rows become the zeroed buffer for the next layer
+        std::fill(frontier.begin() + lo * words, frontier.begin() + (hi + 1) * words, 0);
+        std::swap(frontier, next);
+        lo = firstLive;
+        hi = lastLive;
+    }
+    --layers; // the last layer found nothing
+    return stopping && isReachable(stop);
+}
+
+void Wavefront::computeDistances(Position source)
+{
+    auto start = std::chrono::steady_clock::now();
+    flood(source, { -1, -1 }, true);
+    computeUs = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool Wavefront::connected(Position source, Position target)
+{
+    auto start = std::chrono::steady_clock::now();
+    bool found = flood(source, target, false);
+    computeUs = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return found;
+}
+
+// Floods with distances up to the target, then walks back down the layers
+SearchResult Wavefront::query(Position source, Position target)
+{
+    auto start = std::chrono::steady_clock::now();
+    SearchResult result;
+
+    if (source == Position(-1, -1)) {
+        result.error = NoSourceNode;
+        return result;
+    }
+    if (target == Position(-1, -1)) {
+        result.error = NoTargetNode;
+        return result;
+    }
+
+    if (!flood(source, target, true)) {
+        result.error = NoPath;
+    }
+    else {
+        const Position sides[4] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+        result.waypoints.push_back(target);
+        for (Position pos = target; pos != source; ) {
+            float d = distance[pos.x * rows + pos.y];
+            for (const auto& side : sides) {
+                Position prev = pos + side;
+                if (prev.x >= 0 && prev.x < cols && prev.y >= 0 && prev.y < rows && distance[prev.x * rows + prev.y] == d - 1.0f) {
+                    pos = prev;
+                    break;
+                }
+            }
+            result.waypoints.push_back(pos);
+        }
+        std::reverse(result.waypoints.begin(), result.waypoints.end());
+        result.cost = distance[target.x * rows + target.y];
+    }
+    result.expansions = reachedCells;
+    result.timeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    computeUs = result.timeMs * 1000.0f;
+    return result;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Grid.h"
+#include "Astar.h"
+#include <vector>
+#include <cstdint>
+
+// Unit-cost 4-connected BFS over bit-packed rows. Each grid row is a run of
+// 64-bit words (bit i of word w is column w * 64 + i), and a whole BFS layer
+// is grown with shifts, ors and ands, a word at a time. Only the rows the
+// frontier spans are touched. Serves distance fields, paths, and the
+// 4-connected connectivity checks that 8-connected grid components cannot give.
+class Wavefront
+{
+private:
+	Grid& grid;
+	int cols = 0, rows = 0, words = 0;
+	unsigned int loadedVersion = 0;
+	bool loaded = false;
+
+	std::vector<uint64_t> passable;  // [y * words + w]
+	std::vector<uint64_t> reached;
+	std::vector<uint64_t> frontier;
+	std::vector<uint64_t> next;
+	std::vector<float> distance;     // [x * rows + y], FLT_MAX if not reached
+
+	int layers = 0;
+	int reachedCells = 0;
+	float computeUs = 0.0f;
+
+	void load();
+	bool flood(Position source, Position stop, bool withDistances);
+
+public:
+	Wavefront(Grid& _grid) : grid(_grid) {}
+
+	void computeDistances(Position source);
+	bool connected(Position source, Position target); // stops as soon as the target is reached
+	SearchResult query(Position source, Position target);
+
+	bool isReachable(Position cell) const { return (reached[cell.y * words + cell.x / 64] >> (cell.x % 64)) & 1u; }
+	const std::vector<float>& getDistances() const { return distance; }
+	int getLayers() const { return layers; }
+	int getReachedCells() const { return reachedCells; }
+	float getComputeUs() const { return computeUs; }
+};
@@ -3,6 +3,20 @@
 #include <SFML/Graphics.hpp>
 #include "Grid.h"
 #include "Astar.h"
+#include "Landmarks.h"
+#include "ContractionHierarchy.h"
+#include "SubgoalGraph.h"
+#include "FirstMoveTable.h"
+#include "FlowField.h"
+#include "Wavefront.h"
+#include "CooperativePlanner.h"
+#include "ConflictBasedSearch.h"
+#include "PathCache.h"
+#include "SparseSearch.h"
+#include "Camera.h"
+#include "Benchmark.h"
+#include "Trace.h"
+#include <random>
 
 constexpr float FPS = 60.0f;
 
@@ -63,6 +77,278 @@ static void printError(Astar& a_star) {
     case NoSourceNode:
         ImGui::Text("Error: No Starting Node selected!");
         break;
+    case NoTargetNode:
+        ImGui::Text("Error: No Target Node selected!");
+        break;
+    case NoPath:
+        if (a_star.getResult().expansions == 0)
+            ImGui::Text("Error: Target is in another region!");
+        else
+            ImGui::Text("Error: Target is not reachable!");
+        break;
+    case TimedOut:
+        ImGui::Text("Error: Time budget ran out before a path was found!");
+        break;
+    }
+}
+
+static void printSearchState(Astar& a_star) {
+    switch (a_star.getSearchState())
+    {
+    case SearchState::Running: ImGui::Text("Search: Running"); break;
+    case SearchState::Found: ImGui::Text("Search: Found"); break;
+    case SearchState::NoPath: ImGui::Text("Search: No Path"); break;
+    case SearchState::Cancelled: ImGui::Text("Search: Cancelled"); break;
+    case SearchState::Idle: break;
+    }
+}
+
+static void displayResult(Astar& a_star) {
+    const auto& result = a_star.getResult();
+    if (result.expansions == 0)
+        return;
+
+    ImGui::SeparatorText("Result");
+    ImGui::Text("Waypoints: %d", static_cast<int>(result.waypoints.size()));
+    ImGui::Text("Cost: %.3f", result.cost);
+    ImGui::Text("Expansions: %d", result.expansions);
+    ImGui::Text("Time: %.3f ms", result.timeMs);
+    const auto& arena = a_star.getArena();
+    ImGui::Text("List arena: %.1f KB used, %.1f KB peak, %.1f KB block", arena.getUsedBytes() / 1024.0f, arena.getPeakBytes() / 1024.0f, arena.getBlockBytes() / 1024.0f);
+    ImGui::Text("Search pool: %zu idle, %.1f KB", SearchContextPool::getIdleCount(), SearchContextPool::getMemoryBytes() / 1024.0f);
+}
+
+static void displayAnyAngleStats(Astar& a_star) {
+    const auto& stats = a_star.getAnyAngleStats();
+    if (stats.losChecks == 0)
+        return;
+
+    ImGui::SeparatorText("Any-Angle");
+    ImGui::Text("LOS checks: %lld (%.0f / s)", stats.losChecks, stats.losPerSecond);
+    float gridLength = a_star.getAnyAngleBaseline();
+    ImGui::Text("Length: %.3f, 8-connected: %.3f", stats.length, gridLength);
+    if (gridLength > 0.0f && gridLength != FLT_MAX)
+        ImGui::Text("Improvement: %.2f%%", 100.0f * (gridLength - stats.length) / gridLength);
+}
+
+static void displaySmoothingStats(Astar& a_star) {
+    const auto& stats = a_star.getSmoothingStats();
+    if (stats.outputWaypoints == 0)
+        return;
+
+    ImGui::SeparatorText("Smoothing");
+    ImGui::Text("Cells: %d -> Waypoints: %d", stats.inputCells, stats.outputWaypoints);
+    ImGui::Text("Time: %.2f us", stats.timeUs);
+}
+
+// Expansions and time of the same query under Diagonal_Distance and Landmark_ALT
+struct HeuristicComparison {
+    bool valid = false;
+    int diagonalExpansions = 0;
+    float diagonalMs = 0.0f;
+    int altExpansions = 0;
+    float altMs = 0.0f;
+};
+
+static HeuristicComparison compareHeuristics(Astar& a_star, Grid& grid) {
+    HeuristicComparison comparison;
+    a_star.setVisualize(false);
+
+    a_star.setMethod(Diagonal_Distance);
+    auto diagonal = a_star.searchPath(grid.getSourcePos(), grid.getTargetPos());
+    a_star.setMethod(Landmark_ALT);
+    auto alt = a_star.searchPath(grid.getSourcePos(), grid.getTargetPos());
+
+    a_star.setVisualize(true);
+    comparison.valid = diagonal.error == NoError && alt.error == NoError;
+    comparison.diagonalExpansions = diagonal.expansions;
+    comparison.diagonalMs = diagonal.timeMs;
+    comparison.altExpansions = alt.expansions;
+    comparison.altMs = alt.timeMs;
+    return comparison;
+}
+
+static void displayLandmarkStats(const Landmarks& landmarks, const HeuristicComparison& comparison) {
+    if (landmarks.getCount() == 0 && !landmarks.isBuilding())
+        return;
+
+    ImGui::SeparatorText("Landmarks");
+    if (landmarks.isBuilding())
+        ImGui::Text("Rebuilding in background, using Diagonal");
+    ImGui::Text("Landmarks: %d%s", landmarks.getCount(), landmarks.isValid() ? "" : " (stale)");
+    if (landmarks.isLoadedFromFile())
+        ImGui::Text("Mapped from sidecar: %.2f ms", landmarks.getLoadMs());
+    else
+        ImGui::Text("Preprocessing: %.2f ms", landmarks.getBuildMs());
+    ImGui::Text("Table memory: %.1f KB", landmarks.getMemoryBytes() / 1024.0f);
+
+    if (comparison.valid) {
+        ImGui::Text("Diagonal: %d expansions, %.3f ms", comparison.diagonalExpansions, comparison.diagonalMs);
+        ImGui::Text("ALT: %d expansions, %.3f ms", comparison.altExpansions, comparison.altMs);
+        if (comparison.diagonalExpansions > 0)
+            ImGui::Text("Expansion reduction: %.1f%%", 100.0f * (comparison.diagonalExpansions - comparison.altExpansions) / comparison.diagonalExpansions);
+    }
+}
+
+static void displayHierarchyStats(const ContractionHierarchy& hierarchy) {
+    if (hierarchy.getShortcuts() == 0 && !hierarchy.isValid())
+        return;
+
+    ImGui::SeparatorText("Contraction Hierarchy");
+    ImGui::Text("Preprocessing: %.2f ms%s", hierarchy.getBuildMs(), hierarchy.isValid() ? "" : " (stale)");
+    ImGui::Text("Shortcuts: %d", hierarchy.getShortcuts());
+    ImGui::Text("Memory: %.1f KB", hierarchy.getMemoryBytes() / 1024.0f);
+}
+
+static void displaySubgoalStats(const SubgoalGraph& subgoalGraph) {
+    if (!subgoalGraph.isBuilt())
+        return;
+
+    ImGui::SeparatorText("Subgoal Graph");
+    ImGui::Text("Preprocessing: %.2f ms", subgoalGraph.getBuildMs());
+    ImGui::Text("Subgoals: %d, edges: %d", subgoalGraph.getSubgoals(), subgoalGraph.getEdges());
+    ImGui::Text("Last update: %.1f us (%d subgoals)", subgoalGraph.getUpdateUs(), subgoalGraph.getUpdatedSubgoals());
+}
+
+static void displayFirstMoveStats(const FirstMoveTable& firstMoves) {
+    if (firstMoves.getRuns() == 0)
+        return;
+
+    ImGui::SeparatorText("First-Move Table");
+    ImGui::Text("Preprocessing: %.0f ms on %d threads%s", firstMoves.getBuildMs(), firstMoves.getThreads(), firstMoves.isValid() ? "" : " (stale)");
+    ImGui::Text("Runs: %zu", firstMoves.getRuns());
+    ImGui::Text("Compressed: %.1f KB (dense %.1f KB)", firstMoves.getMemoryBytes() / 1024.0f, firstMoves.getUncompressedBytes() / 1024.0f);
+    ImGui::Text("Lookup: %.0f ns", firstMoves.getLookupNs());
+}
+
+static void displayFlowFieldStats(const FlowField& flowField) {
+    ImGui::SeparatorText("Flow Field");
+    if (!flowField.isValid()) {
+        ImGui::Text("Place a target to compute the field");
+        return;
+    }
+    ImGui::Text("Full compute: %.2f ms", flowField.getBuildMs());
+    ImGui::Text("Last update: %.1f us (%d cells)", flowField.getUpdateUs(), flowField.getUpdatedCells());
+}
+
+static void displayWavefrontStats(const Wavefront& wavefront) {
+    ImGui::SeparatorText("Wavefront");
+    ImGui::Text("Layers: %d, cells reached: %d", wavefront.getLayers(), wavefront.getReachedCells());
+    ImGui::Text("Time: %.1f us", wavefront.getComputeUs());
+}
+
+static void displayCacheStats(const PathCache& pathCache) {
+    ImGui::SeparatorText("Path Cache");
+    ImGui::Text("Entries: %zu/%zu, %.1f KB", pathCache.getEntries(), pathCache.getCapacity(), pathCache.getMemoryBytes() / 1024.0f);
+    ImGui::Text("Hit rate: %.1f%% (%lld exact, %lld suffix, %lld misses)", pathCache.getHitRate() * 100.0f, pathCache.getHits(), pathCache.getSuffixHits(), pathCache.getMisses());
+    ImGui::Text("Evicted: %lld, invalidated by edits: %lld", pathCache.getEvictions(), pathCache.getInvalidations());
+}
+
+static void displaySparseWorldStats(const SparseGrid& world, const SparseSearch& worldSearch) {
+    ImGui::SeparatorText("Sparse World");
+    ImGui::Text("Chunks: %zu (%d full), %.1f KB", world.getChunkCount(), world.getFullChunks(), world.getMemoryBytes() / 1024.0f);
+    ImGui::Text("Search: %d expansions, %zu cells touched, %.2f ms", worldSearch.getExpansions(), worldSearch.getTouchedCells(), worldSearch.getTimeMs());
+    ImGui::Text("Chunk cache hit rate: %.1f%%", worldSearch.getReaderHitRate() * 100.0);
+}
+
+static void displayCooperativeStats(const CooperativePlanner& cooperative) {
+    ImGui::SeparatorText("Multi-Agent");
+    ImGui::Text("Agents: %d, arrived: %d, time: %d", static_cast<int>(cooperative.getAgents().size()), cooperative.getArrived(), cooperative.getTime());
+    ImGui::Text("Collisions: %d", cooperative.getCollisions());
+    ImGui::Text("Last plan: %.2f ms, %d/%d planned", cooperative.getPlanMs(), cooperative.getPlanned(), static_cast<int>(cooperative.getAgents().size()));
+    ImGui::Text("Throughput: %.0f agents/s", cooperative.getAgentsPerSecond());
+}
+
+static void displayConflictStats(const ConflictBasedSearch& cbs) {
+    ImGui::SeparatorText("MAPF");
+    if (cbs.hasTimedOut())
+        ImGui::Text("Timed out after %.1f ms", cbs.getSolveMs());
+    else if (!cbs.isSolved())
+        ImGui::Text("No solution after %.1f ms", cbs.getSolveMs());
+    else
+        ImGui::Text("Sum of costs: %d in %.1f ms", cbs.getCost(), cbs.getSolveMs());
+    ImGui::Text("High-level nodes: %d, low-level expansions: %lld", cbs.getHighLevelNodes(), cbs.getLowLevelExpansions());
+}
+
+static void displayBenchmark(const std::vector<BenchmarkRow>& rows) {
+    if (rows.empty())
+        return;
+
+    ImGui::SeparatorText("Benchmark");
+    if (ImGui::BeginTable("Benchmark", 5, ImGuiTableFlags_Borders)) {
+        ImGui::TableSetupColumn("Engine");
+        ImGui::TableSetupColumn("Solved");
+        ImGui::TableSetupColumn("Avg (us)");
+        ImGui::TableSetupColumn("Max (us)");
+        ImGui::TableSetupColumn("Expanded");
+        ImGui::TableHeadersRow();
+        for (const auto& row : rows) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::Text("%s", row.name.c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%d/%d", row.solved, row.queries);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", row.avgUs);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", row.maxUs);
+            ImGui::TableNextColumn(); ImGui::Text("%lld", row.expansions);
+        }
+        ImGui::EndTable();
+    }
+}
+
+static void displayProfiler(Astar& a_star) {
+    ImGui::SeparatorText("Profiler");
+    bool profiling = a_star.isProfiling();
+    if (ImGui::Checkbox("Profile searches", &profiling))
+        a_star.setProfiling(profiling);
+
+    const auto& profile = a_star.getProfile();
+    if (profile.query == 0)
+        return;
+
+    ImGui::Text("Query #%u: %.3f ms", profile.query, profile.totalMs);
+    ImGui::Text("Expanded: %d  Generated: %d  Reopened: %d", profile.expanded, profile.generated, profile.reopened);
+    ImGui::Text("Open peak: %d", profile.openPeak);
+    if (!profiling)
+        return;
+
+    ImGui::Text("Heuristic: %.1f us  Neighbours: %.1f us", profile.heuristicUs, profile.neighbourUs);
+    ImGui::PlotLines("Time (ms)", a_star.getHistoryMs(), a_star.getHistorySize(), a_star.getHistoryHead(), nullptr, 0.0f, FLT_MAX, ImVec2(0, 50));
+    ImGui::PlotLines("Expanded", a_star.getHistoryExpanded(), a_star.getHistorySize(), a_star.getHistoryHead(), nullptr, 0.0f, FLT_MAX, ImVec2(0, 50));
+}
+
+static void saveTrace() {
+    if (Trace::writeJson("trace.json"))
+        std::cout << "Wrote " << Trace::getCount() << " spans to trace.json\n";
+    else
+        std::cout << "Could not write trace.json\n";
+}
+
+static void displaySearchQuality(Astar& a_star) {
+    if (a_star.getEpsilon() == FLT_MAX)
+        ImGui::Text("Suboptimality bound: none (no path)");
+    else
+        ImGui::Text("Suboptimality bound: %.3f", a_star.getEpsilon());
+
+    const auto& history = a_star.getAnytimeHistory();
+    if (history.empty())
+        return;
+
+    std::vector<float> costs;
+    for (const auto& solution : history)
+        costs.push_back(solution.cost);
+    ImGui::PlotLines("Cost", costs.data(), static_cast<int>(costs.size()), 0, nullptr, FLT_MAX, FLT_MAX, ImVec2(0, 60));
+
+    if (ImGui::BeginTable("Anytime", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY, ImVec2(0, 120))) {
+        ImGui::TableSetupColumn("Time (ms)");
+        ImGui::TableSetupColumn("Cost");
+        ImGui::TableSetupColumn("Epsilon");
+        ImGui::TableHeadersRow();
+        for (const auto& solution : history) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", solution.timeMs);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", solution.cost);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", solution.epsilon);
+        }
+        ImGui::EndTable();
     }
 }
 
@@ -85,26 +371,115 @@ int main()
 
     Grid grid(window, backGround);
     grid.initialize();
+    Camera camera(window, backGround.getSize());
     Astar a_star(grid);
+    Landmarks landmarks(grid);
+    a_star.setLandmarks(&landmarks);
+    ContractionHierarchy hierarchy(grid);
+    SubgoalGraph subgoalGraph(grid);
+    FirstMoveTable firstMoves(grid);
+    FlowField flowField(grid);
+    Wavefront wavefront(grid);
+    CooperativePlanner cooperative(grid);
+    ConflictBasedSearch cbs;
+    PathCache pathCache(grid);
+    SparseGrid world;
+    SparseSearch worldSearch(world);
 
     // slider Method
     static int method = Manhattan_Distance;
-    const char* method_names[Method_Count] = { "Manhattan Distance", "Diagonal Distance", "Euclidean Distance" };
+    const char* method_names[Method_Count] = { "Manhattan Distance", "Diagonal Distance", "Euclidean Distance", "Landmarks (ALT)" };
+
+    // ALT preprocessing
+    static int landmarkCount = 8;
+    HeuristicComparison heuristicComparison;
+
+    // Preprocessed query engines
+    enum QueryEngine { Plain_Search, Hierarchy_Engine, Subgoal_Engine, First_Move_Engine, Wavefront_Engine };
+    static int queryEngine = Plain_Search;
+    static int cellOrder = Column_Major;
+    std::vector<BenchmarkRow> benchmarkRows;
+
+    // Flow field towards the target
+    enum FlowOverlay { No_Overlay, Heatmap_Overlay, Arrow_Overlay };
+    static bool wantFlowField = false;
+    static int flowOverlay = Heatmap_Overlay;
+
+    // Unit-cost distance field from the source
+    static bool showWavefront = false;
+
+    // Recorded search replay
+    SearchRecording recording;
+    static bool recordSearches = false;
+    static bool showReplay = false;
+    static bool replayPlaying = false;
+    static int replaySpeed = 64; // events per frame
+    static int replayView = -1;  // -1 for the step-by-step view, else a RecordingOverlay
+    const char* overlay_names[RecordingOverlay_Count] = { "Order", "g", "h error", "Re-expanded" };
+    unsigned int overlaySequence = 0, overlayVersion = 0; // recording and grid the overlay was computed from
+    int overlayView = -1;
+
+    // Cooperative agents
+    static int agentCount = 100;
+    static int agentWindow = 16;
+    static bool runAgents = false;
+    static int framesPerStep = 8;
+    int agentFrame = 0;
+
+    // Conflict-based search over MovingAI scenarios or the agents above
+    static char scenarioPath[256] = "maps/arena.map-random-1.scen";
+    static float suboptimality = 1.0f; // 1 for CBS, above for ECBS
+    static int mapfTimeLimit = 1000;   // ms
+    static int mapfMaxAgents = 20;
+    MapfScenario scenario;
+    bool scenarioLoaded = false;
+    bool showMapf = false;
+    std::vector<std::vector<Position>> mapfPaths;
+    Position agentStart = { -1, -1 }; // placed with Shift + left click, awaiting its goal
+
+    // Sparse world shown through the grid area, cell origin at its top left
+    static bool showWorld = false;
+    static int worldOrigin[2] = { 0, 0 };
+    static int worldTarget[2] = { 20000, 5000 };
+    static int worldExpansions = 1 << 20;
+    std::vector<Position> worldPath;
+
+    // Map larger than the window, seen through the camera
+    static int mapSize[2] = { 0, 0 }; // {0, 0} fits the window
+    static bool levelOfDetail = true;
 
     // Node size
     static int nodeSize = 0;
 
     //debug window
     bool display_node_data = false;
+#ifdef _DEBUG
+    static long long warmAllocations = -1; // from the last allocation self-test, -1 before one ran
+#endif
 
     static int delayMs = 0;
     static bool wantDelay = false;
 
+    // Repeated queries answered from the path cache
+    static bool cachePaths = false;
+
+    // Weighted / anytime search
+    static float weight = 1.0f;
+    static bool wantAnytime = false;
+    static int budgetMs = 50;
+    static bool wantAnyAngle = false;
+
+    // Path post-processing
+    static int smoothing = No_Smoothing;
+    const char* smoothing_names[Smoothing_Count] = { "None", "String Pulling", "Catmull-Rom" };
+
     sf::Clock clock;
 
     while (window.isOpen())
     {
+        TraceSpan frameSpan("Frame");
         sf::Event event;
+        window.setView(camera.getView()); // mouse positions map through the camera
 
         while (window.pollEvent(event))
         {
@@ -113,29 +488,52 @@ int main()
             if (event.type == sf::Event::Closed)
                 window.close();
 
-            if (event.type == sf::Event::MouseButtonPressed) {
+            camera.handleEvent(event, window);
+            if (event.type == sf::Event::MouseButtonPressed && camera.containsPixel({ event.mouseButton.x, event.mouseButton.y })) {
                 if (event.mouseButton.button == sf::Mouse::Left && sf::Keyboard::isKeyPressed(sf::Keyboard::LControl))
                     grid.updateColor(mousePos, NodeState::Source);
 
                 else if (event.mouseButton.button == sf::Mouse::Right && sf::Keyboard::isKeyPressed(sf::Keyboard::LControl))
                     grid.updateColor(mousePos, NodeState::Target);
+
+                else if (sf::Keyboard::isKeyPressed(sf::Keyboard::LShift)) {
+                    auto node = grid.on_mouse_hover(mousePos);
+                    if (node && event.mouseButton.button == sf::Mouse::Left)
+                        agentStart = node->getWorldPosition();
+                    else if (node && event.mouseButton.button == sf::Mouse::Right && agentStart != Position(-1, -1)) {
+                        if (cooperative.addAgent(agentStart, node->getWorldPosition()))
+                            cooperative.planAll();
+                        agentStart = { -1, -1 };
+                    }
+                }
             }
 
             if (event.type == sf::Event::KeyPressed) {
                 if (event.key.code == sf::Keyboard::Space) {
+                    a_star.cancelSearch();
                     grid.Reset();
                     a_star.clearContainers();
                 }
 
+                else if (event.key.code == sf::Keyboard::F9)
+                    Trace::setEnabled(!Trace::isEnabled());
+
+                else if (event.key.code == sf::Keyboard::F10)
+                    saveTrace();
+
                 else if (event.key.code == sf::Keyboard::Escape)
                     window.close();
             }
         }
 
-        ImGui::SFML::Update(window, clock.restart());
+        {
+            TraceSpan span("ImGui::SFML::Update");
+            ImGui::SFML::Update(window, clock.restart());
+        }
 
         sf::Vector2f mousePos = getmousePos(window);
-        if (!sf::Keyboard::isKeyPressed(sf::Keyboard::LControl)) {
+        if (!sf::Keyboard::isKeyPressed(sf::Keyboard::LControl) && !sf::Keyboard::isKeyPressed(sf::Keyboard::LShift)
+            && camera.containsPixel(sf::Mouse::getPosition(window))) {
             if (sf::Mouse::isButtonPressed(sf::Mouse::Right))
                 grid.updateColor(mousePos, NodeState::Blocked);
 
@@ -152,10 +550,53 @@ int main()
             // Run algorithm
             ImGui::SeparatorText("Run Algorithm");
             if (ImGui::Button("Start A*")) {
-                if (wantDelay)
-                    a_star.startSearch(delayMs);
+                Position source = grid.getSourcePos();
+                Position target = grid.getTargetPos();
+                if (queryEngine == Hierarchy_Engine && hierarchy.isValid())
+                    a_star.showResult(hierarchy.query(source, target));
+                else if (queryEngine == Subgoal_Engine && subgoalGraph.isBuilt())
+                    a_star.showResult(subgoalGraph.query(source, target));
+                else if (queryEngine == First_Move_Engine && firstMoves.isValid())
+                    a_star.showResult(firstMoves.query(source, target));
+                else if (queryEngine == Wavefront_Engine)
+                    a_star.showResult(wavefront.query(source, target));
+                else if (wantFlowField && flowField.isValid())
+                    a_star.showResult(flowField.path(source));
+                else if (wantAnyAngle)
+                    a_star.searchAnyAngle(source, target);
+                else if (method == Manhattan_Distance && source != Position(-1, -1) && target != Position(-1, -1) && !wavefront.connected(source, target)) {
+                    // Grid components join cells diagonally, so only the 4-way flood can reject these
+                    SearchResult rejected;
+                    rejected.error = NoPath;
+                    a_star.showResult(rejected);
+                }
+                else if (wantAnytime)
+                    a_star.searchAnytime(source, target, weight, budgetMs);
+                else if (wantDelay)
+                    a_star.startSearch(source, target, delayMs);
+                else if (recordSearches) {
+                    // Full speed, the replay shows the search instead of the nodes
+                    a_star.setVisualize(false);
+                    a_star.searchPath(source, target);
+                    a_star.setVisualize(true);
+                    showReplay = true;
+                    replayPlaying = false;
+                }
+                else if (cachePaths) {
+                    a_star.setVisualize(false);
+                    SearchResult cached = pathCache.query(source, target, static_cast<Method>(method), weight, [&](Position s, Position t) { return a_star.searchPath(s, t); });
+                    a_star.setVisualize(true);
+                    a_star.showResult(cached);
+                }
                 else
-                    a_star.searchPath();
+                    a_star.searchPath(source, target);
+            }
+            ImGui::SameLine();
+            ImGui::Checkbox("Cache paths", &cachePaths);
+            if (a_star.isSearchRunning()) {
+                ImGui::SameLine();
+                if (ImGui::Button("Cancel"))
+                    a_star.cancelSearch();
             }
 
             //Method Slider
@@ -163,6 +604,360 @@ int main()
             const char* method_name = (method >= 0 && method < Method_Count) ? method_names[method] : "Unknown";
             ImGui::SliderInt("Method", &method, 0, Method_Count - 1, method_name);
 
+            if (method == Landmark_ALT) {
+                ImGui::SliderInt("Landmarks", &landmarkCount, 1, 16);
+                if (ImGui::Button("Build Landmarks")) {
+                    landmarks.prepare(landmarkCount);
+                    heuristicComparison = HeuristicComparison();
+                }
+                ImGui::SameLine();
+                if (ImGui::Button("Compare with Diagonal"))
+                    heuristicComparison = compareHeuristics(a_star, grid);
+            }
+
+            // Weighted A* / ARA*
+            ImGui::SeparatorText("Heuristic Weight");
+            if (ImGui::SliderFloat("Weight", &weight, 1.0f, 5.0f, "%.2f"))
+                a_star.setWeight(weight);
+            ImGui::Checkbox("Anytime (ARA*)", &wantAnytime);
+            if (wantAnytime)
+                ImGui::SliderInt("Budget (ms)", &budgetMs, 1, 1000);
+            ImGui::Checkbox("Any-Angle (Lazy Theta*)", &wantAnyAngle);
+
+            // Preprocessing
+            ImGui::SeparatorText("Preprocessing");
+            if (ImGui::Button("Build Hierarchy"))
+                hierarchy.build();
+            ImGui::SameLine();
+            if (ImGui::Button("Build Subgoals"))
+                subgoalGraph.build();
+            ImGui::SameLine();
+            if (ImGui::Button("Build First Moves"))
+                firstMoves.build();
+
+            ImGui::RadioButton("A*", &queryEngine, Plain_Search);
+            ImGui::SameLine();
+            ImGui::RadioButton("Hierarchy", &queryEngine, Hierarchy_Engine);
+            ImGui::SameLine();
+            ImGui::RadioButton("Subgoals", &queryEngine, Subgoal_Engine);
+            ImGui::SameLine();
+            ImGui::RadioButton("First Moves", &queryEngine, First_Move_Engine);
+            ImGui::RadioButton("Wavefront (4-way)", &queryEngine, Wavefront_Engine);
+
+            // Memory order of the headless search state
+            ImGui::Text("Search state:");
+            ImGui::SameLine();
+            bool orderChanged = ImGui::RadioButton("Columns", &cellOrder, Column_Major);
+            ImGui::SameLine();
+            orderChanged |= ImGui::RadioButton("Rows", &cellOrder, Row_Major);
+            ImGui::SameLine();
+            orderChanged |= ImGui::RadioButton("8x8 Tiles", &cellOrder, Tiled_8x8);
+            if (orderChanged)
+                a_star.setCellOrder(static_cast<CellOrder>(cellOrder));
+
+            if (ImGui::Button("Benchmark")) {
+                auto scenarios = Benchmark::randomScenarios(grid, 200, 1);
+                a_star.setVisualize(false);
+                a_star.setMethod(Diagonal_Distance);
+                benchmarkRows = { Benchmark::run("A* (Diagonal)", scenarios, [&](Position s, Position t) { return a_star.searchPath(s, t); }) };
+                if (hierarchy.isValid())
+                    benchmarkRows.push_back(Benchmark::run("Hierarchy", scenarios, [&](Position s, Position t) { return hierarchy.query(s, t); }));
+                if (firstMoves.isValid())
+                    benchmarkRows.push_back(Benchmark::run("First moves", scenarios, [&](Position s, Position t) { return firstMoves.query(s, t); }));
+                benchmarkRows.push_back(Benchmark::run("Wavefront (4-way)", scenarios, [&](Position s, Position t) { return wavefront.query(s, t); }));
+                if (subgoalGraph.isBuilt()) {
+                    benchmarkRows.push_back(Benchmark::run("Subgoals", scenarios, [&](Position s, Position t) { return subgoalGraph.query(s, t); }));
+
+                    // Each edit blocks a free cell and frees it again, updating the graph both times.
+                    // Edits go to a copy of the grid so the other engines stay valid.
+                    std::vector<Position> cells;
+                    for (const auto& scenario : Benchmark::randomScenarios(grid, 50, 2))
+                        if (scenario.source != grid.getSourcePos() && scenario.source != grid.getTargetPos())
+                            cells.push_back(scenario.source);
+                    Grid scratch(grid);
+                    SubgoalGraph scratchGraph(scratch);
+                    scratchGraph.build();
+                    benchmarkRows.push_back(Benchmark::runEdits("Subgoal edit", cells, [&](Position cell) {
+                        scratch.setCell(cell, NodeState::Blocked);
+                        scratchGraph.update();
+                        scratch.setCell(cell, NodeState::Unblocked);
+                        scratchGraph.update();
+                    }));
+                }
+                a_star.setVisualize(true);
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Benchmark Lists"))
+                benchmarkRows = Benchmark::containerAllocators(1000000);
+            ImGui::SameLine();
+            if (ImGui::Button("Benchmark Layouts"))
+                benchmarkRows = Benchmark::cellLayouts(1024, 10);
+            ImGui::SameLine();
+            if (ImGui::Button("Benchmark Cache")) {
+                // 50 pairs asked 8 times each in a shuffled order, then the same from a cell along each path
+                auto pairs = Benchmark::randomScenarios(grid, 50, 4);
+                std::vector<Scenario> scenarios;
+                for (int round = 0; round < 8; ++round)
+                    for (size_t i = 0; i < pairs.size(); ++i)
+                        scenarios.push_back(pairs[(i * 7 + round * 13) % pairs.size()]);
+                a_star.setVisualize(false);
+                for (const auto& pair : pairs) {
+                    const auto& waypoints = a_star.searchPath(pair.source, pair.target).waypoints;
+                    if (waypoints.size() > 2)
+                        scenarios.push_back({ waypoints[waypoints.size() / 2], pair.target });
+                }
+                Method cacheMethod = static_cast<Method>(method);
+                pathCache.clear();
+                benchmarkRows = {
+                    Benchmark::run("A* uncached", scenarios, [&](Position s, Position t) { return a_star.searchPath(s, t); }),
+                    Benchmark::run("A* cached", scenarios, [&](Position s, Position t) {
+                        return pathCache.query(s, t, cacheMethod, weight, [&](Position s, Position t) { return a_star.searchPath(s, t); });
+                    })
+                };
+
+                // Each edit blocks a free cell and frees it again, invalidating both times.
+                // Edits go to a copy of the grid with its own filled cache so the other engines stay valid.
+                std::vector<Position> cells;
+                for (const auto& scenario : Benchmark::randomScenarios(grid, 50, 5))
+                    if (scenario.source != grid.getSourcePos() && scenario.source != grid.getTargetPos())
+                        cells.push_back(scenario.source);
+                Grid scratch(grid);
+                Astar scratchSearch(scratch);
+                scratchSearch.setVisualize(false);
+                scratchSearch.setMethod(cacheMethod);
+                scratchSearch.setWeight(weight);
+                PathCache scratchCache(scratch, pathCache.getCapacity());
+                for (const auto& scenario : scenarios)
+                    scratchCache.query(scenario.source, scenario.target, cacheMethod, weight, [&](Position s, Position t) { return scratchSearch.searchPath(s, t); });
+                benchmarkRows.push_back(Benchmark::runEdits("Cache invalidation", cells, [&](Position cell) {
+                    scratch.setCell(cell, NodeState::Blocked);
+                    scratchCache.update();
+                    scratch.setCell(cell, NodeState::Unblocked);
+                    scratchCache.update();
+                }));
+                a_star.setVisualize(true);
+            }
+
+            // One search shared by every agent heading to the target
+            ImGui::SeparatorText("Flow Field");
+            ImGui::Checkbox("Flow field to target", &wantFlowField);
+            ImGui::BeginDisabled(!wantFlowField);
+            ImGui::RadioButton("None", &flowOverlay, No_Overlay);
+            ImGui::SameLine();
+            ImGui::RadioButton("Heatmap", &flowOverlay, Heatmap_Overlay);
+            ImGui::SameLine();
+            ImGui::RadioButton("Arrows", &flowOverlay, Arrow_Overlay);
+            if (ImGui::Button("Benchmark Agents") && flowField.isValid()) {
+                auto scenarios = Benchmark::randomScenarios(grid, 200, 3);
+                for (auto& scenario : scenarios)
+                    scenario.target = grid.getTargetPos();
+                a_star.setVisualize(false);
+                a_star.setMethod(Diagonal_Distance);
+                benchmarkRows = {
+                    Benchmark::run("A* per agent", scenarios, [&](Position s, Position t) { return a_star.searchPath(s, t); }),
+                    Benchmark::run("Flow field", scenarios, [&](Position s, Position) { return flowField.path(s); })
+                };
+                a_star.setVisualize(true);
+            }
+            ImGui::EndDisabled();
+
+            // Bit-parallel BFS from the source
+            ImGui::SeparatorText("Wavefront");
+            if (ImGui::Button("Distance Field")) {
+                wavefront.computeDistances(grid.getSourcePos());
+                showWavefront = true;
+            }
+            ImGui::SameLine();
+            ImGui::Checkbox("Show field", &showWavefront);
+
+            // Searches recorded at full speed, scrubbed afterwards
+            ImGui::SeparatorText("Replay");
+            if (ImGui::Checkbox("Record searches", &recordSearches))
+                a_star.setRecording(recordSearches ? &recording : nullptr);
+            if (!recording.isEmpty()) {
+                ImGui::SameLine();
+                ImGui::Checkbox("Show replay", &showReplay);
+                ImGui::RadioButton("Steps", &replayView, -1);
+                for (int overlay = 0; overlay < RecordingOverlay_Count; ++overlay) {
+                    ImGui::SameLine();
+                    ImGui::RadioButton(overlay_names[overlay], &replayView, overlay);
+                }
+                int step = static_cast<int>(recording.getStep());
+                if (ImGui::SliderInt("Step", &step, 0, static_cast<int>(recording.getLength())))
+                    recording.seek(step);
+                if (ImGui::Button(replayPlaying ? "Pause" : "Play")) {
+                    replayPlaying = !replayPlaying;
+                    if (replayPlaying && recording.getStep() == recording.getLength())
+                        recording.seek(0);
+                }
+                ImGui::SameLine();
+                if (ImGui::Button("<"))
+                    recording.seek(recording.getStep() - std::min<size_t>(recording.getStep(), replaySpeed));
+                ImGui::SameLine();
+                if (ImGui::Button(">"))
+                    recording.seek(recording.getStep() + replaySpeed);
+                ImGui::SliderInt("Events/frame", &replaySpeed, 1, 10000, "%d", ImGuiSliderFlags_Logarithmic);
+                ImGui::Text("%zu events, %.1f KB", recording.getLength(), recording.getMemoryBytes() / 1024.0f);
+            }
+
+            // Many agents sharing the map through a reservation table
+            ImGui::SeparatorText("Multi-Agent (WHCA*)");
+            ImGui::TextDisabled("Shift + Left: agent start, Shift + Right: its goal");
+            if (ImGui::SliderInt("Window", &agentWindow, 4, 32))
+                cooperative.setWindow(agentWindow);
+            ImGui::SliderInt("Agents", &agentCount, 1, 1000);
+            if (ImGui::Button("Random Agents")) {
+                cooperative.randomAgents(agentCount, 7);
+                cooperative.planAll();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Clear Agents")) {
+                cooperative.clearAgents();
+                runAgents = false;
+                mapfPaths.clear();
+                showMapf = false;
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Benchmark WHCA*")) {
+                benchmarkRows.clear();
+                // The first plan also grows each goal's reverse search; replans reuse it
+                for (int count : { 100, 1000 }) {
+                    cooperative.randomAgents(count, 11);
+                    int agents = static_cast<int>(cooperative.getAgents().size()); // fewer when the grid has fewer free cells
+                    if (agents == 0)
+                        break;
+                    for (const char* pass : { "first", "replan" }) {
+                        cooperative.planAll();
+                        BenchmarkRow row;
+                        row.name = "WHCA* " + std::to_string(agents) + " " + pass + " (" + std::to_string(static_cast<int>(cooperative.getAgentsPerSecond())) + "/s)";
+                        row.queries = agents;
+                        row.solved = cooperative.getPlanned();
+                        row.avgUs = cooperative.getPlanMs() * 1000.0f / agents;
+                        row.expansions = cooperative.getExpansions();
+                        benchmarkRows.push_back(row);
+                    }
+                }
+                cooperative.clearAgents();
+                runAgents = false;
+            }
+            ImGui::Checkbox("Run Agents", &runAgents);
+            ImGui::SameLine();
+            ImGui::SliderInt("Frames/step", &framesPerStep, 1, 30);
+
+            // Optimal (CBS) or bounded-suboptimal (ECBS) multi-agent paths
+            ImGui::SeparatorText("MAPF (CBS/ECBS)");
+            ImGui::InputText("Scenario", scenarioPath, sizeof(scenarioPath));
+            if (ImGui::Button("Load Scenario"))
+                scenarioLoaded = MapfScenario::load(scenarioPath, scenario);
+            ImGui::SameLine();
+            if (scenarioLoaded)
+                ImGui::Text("%dx%d, %zu agents", scenario.cols, scenario.rows, scenario.agents.size());
+            else
+                ImGui::TextDisabled("No scenario");
+            ImGui::SliderFloat("Suboptimality", &suboptimality, 1.0f, 2.0f, "%.2f");
+            ImGui::SliderInt("Time limit (ms)", &mapfTimeLimit, 100, 30000);
+            ImGui::SliderInt("Max agents", &mapfMaxAgents, 1, 200);
+            ImGui::BeginDisabled(!scenarioLoaded);
+            if (ImGui::Button("Run Sweep"))
+                benchmarkRows = cbs.sweep(scenario, std::max(1, mapfMaxAgents / 10), mapfMaxAgents, suboptimality, mapfTimeLimit);
+            ImGui::EndDisabled();
+            ImGui::SameLine();
+            ImGui::BeginDisabled(cooperative.getAgents().empty());
+            if (ImGui::Button("Solve Agents on Grid")) {
+                std::vector<MapfAgent> mapfAgents;
+                for (const auto& agent : cooperative.getAgents())
+                    mapfAgents.push_back({ agent.start, agent.goal });
+                cbs.setMap(grid);
+                mapfPaths.clear();
+                if (cbs.solve(mapfAgents, suboptimality, mapfTimeLimit))
+                    mapfPaths = cbs.getPaths();
+                showMapf = true;
+            }
+            ImGui::EndDisabled();
+            if (!benchmarkRows.empty() && benchmarkRows.front().name.find("CBS") != std::string::npos) {
+                int solved = 0;
+                for (const auto& row : benchmarkRows)
+                    solved += row.solved;
+                ImGui::Text("Success: %d/%zu within %d ms", solved, benchmarkRows.size(), mapfTimeLimit);
+            }
+
+            // Post-processing
+            ImGui::SeparatorText("Path Smoothing");
+            const char* smoothing_name = (smoothing >= 0 && smoothing < Smoothing_Count) ? smoothing_names[smoothing] : "Unknown";
+            if (ImGui::SliderInt("Smoothing", &smoothing, 0, Smoothing_Count - 1, smoothing_name))
+                a_star.setSmoothing(static_cast<Smoothing>(smoothing));
+
+            // Unbounded world in chunks, viewed through the grid area
+            ImGui::SeparatorText("Sparse World");
+            ImGui::Checkbox("Show world", &showWorld);
+            ImGui::SameLine();
+            ImGui::Text("(grid area from cell %d, %d)", worldOrigin[0], worldOrigin[1]);
+            ImGui::InputInt2("Origin", worldOrigin);
+            if (ImGui::Button("Scatter Obstacles")) {
+                // Walls strewn over two million cells square, plus a dense patch at the origin
+                std::mt19937 rng(9);
+                std::uniform_int_distribution<int> spread(-1000000, 1000000), extent(1, 400), cell(0, 255);
+                world.clear();
+                for (int i = 0; i < 5000; ++i) {
+                    Position corner(spread(rng), spread(rng));
+                    Position size = (i % 2) ? Position(extent(rng), 2) : Position(2, extent(rng));
+                    world.fillRect(corner, corner + size, true);
+                }
+                for (int i = 0; i < 16000; ++i)
+                    world.setBlocked({ worldOrigin[0] + cell(rng), worldOrigin[1] + cell(rng) }, true);
+                world.fillRect({ worldOrigin[0] + 300, worldOrigin[1] - 200 }, { worldOrigin[0] + 427, worldOrigin[1] + 200 }, true);
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Copy Grid")) {
+                Position dim = grid.getDimensions();
+                for (int x = 0; x < dim.x; ++x)
+                    for (int y = 0; y < dim.y; ++y)
+                        world.setBlocked({ worldOrigin[0] + x, worldOrigin[1] + y }, grid.isBlocked({ x, y }));
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Clear World")) {
+                world.clear();
+                worldPath.clear();
+            }
+            ImGui::InputInt2("World target", worldTarget);
+            ImGui::SliderInt("Max expansions", &worldExpansions, 1 << 14, 1 << 23, "%d", ImGuiSliderFlags_Logarithmic);
+            if (ImGui::Button("Search World")) {
+                // From the grid's source (or the origin without one), in world cells
+                Position origin(worldOrigin[0], worldOrigin[1]);
+                Position source = grid.getSourcePos() == Position(-1, -1) ? origin : grid.getSourcePos() + origin;
+                worldSearch.setMaxExpansions(worldExpansions);
+                worldPath = worldSearch.query(source, { worldTarget[0], worldTarget[1] }).waypoints;
+            }
+
+            // Wheel zooms, middle drag pans
+            ImGui::SeparatorText("Camera");
+            ImGui::Text("Zoom %.2f, %d quads drawn", camera.getZoom(), grid.getDrawnQuads());
+            if (grid.getLodBlock() > 0) {
+                ImGui::SameLine();
+                ImGui::Text("(%dx%d blocks)", grid.getLodBlock(), grid.getLodBlock());
+            }
+            if (ImGui::Checkbox("Level of detail", &levelOfDetail))
+                grid.setLevelOfDetail(levelOfDetail);
+            ImGui::SameLine();
+            if (ImGui::Button("Reset View"))
+                camera.reset();
+            ImGui::SameLine();
+            if (ImGui::Button("Fit Map")) {
+                Position dim = grid.getDimensions();
+                camera.frame(Pos(static_cast<float>(dim.x), static_cast<float>(dim.y)) * grid.getCellSize());
+            }
+            ImGui::InputInt2("Map size", mapSize);
+            ImGui::SameLine();
+            if (ImGui::Button("Apply")) {
+                // Every cell is a shape of its own, so very large maps are capped
+                mapSize[0] = std::clamp(mapSize[0], 0, 1024);
+                mapSize[1] = std::clamp(mapSize[1], 0, 1024);
+                grid.setFixedDimensions({ mapSize[0], mapSize[1] });
+                grid.reinitialize(grid.getCellSize());
+                Position dim = grid.getDimensions();
+                camera.frame(Pos(static_cast<float>(dim.x), static_cast<float>(dim.y)) * grid.getCellSize());
+            }
+
             // Resize node
             ImGui::SeparatorText("Resize Node");
             if (ImGui::SliderInt("Size", &nodeSize, 10, 100))
@@ -171,6 +966,24 @@ int main()
             // display node data
             ImGui::SeparatorText("Debug Tools");
             ImGui::Checkbox("Display Node Data", &display_node_data);
+            bool tracing = Trace::isEnabled();
+            if (ImGui::Checkbox("Record Trace (F9)", &tracing))
+                Trace::setEnabled(tracing);
+            ImGui::SameLine();
+            if (ImGui::Button("Save (F10)"))
+                saveTrace();
+            ImGui::Text("Trace spans: %llu", static_cast<unsigned long long>(Trace::getCount()));
+
+#ifdef _DEBUG
+            // Warm headless A* must not touch the heap
+            if (ImGui::Button("Check Allocations"))
+                warmAllocations = static_cast<long long>(Benchmark::headlessAllocations(a_star, Benchmark::randomScenarios(grid, 200, 6)));
+            if (warmAllocations >= 0) {
+                ImGui::SameLine();
+                ImGui::TextColored(warmAllocations == 0 ? ImVec4(0.4f, 1.0f, 0.4f, 1.0f) : ImVec4(1.0f, 0.4f, 0.4f, 1.0f),
+                    "%lld allocations over 200 warm queries", warmAllocations);
+            }
+#endif
 
             //Miscellaneous
             ImGui::SeparatorText("Miscellaneous");
@@ -180,6 +993,7 @@ int main()
                 ImGui::SliderInt("Delay", &delayMs, 0, 100);
 
             if (ImGui::Button("Clear Grid")) {
+                a_star.cancelSearch();
                 grid.Reset();
                 a_star.clearContainers();
                 a_star.resetAstar();
@@ -193,7 +1007,31 @@ int main()
 
         ImGui::Begin("Output", nullptr, ImGuiWindowFlags_NoResize);
 
+        ImGui::Text("Free regions: %d", grid.getComponentCount());
         printError(a_star);
+        printSearchState(a_star);
+        displayResult(a_star);
+        displayProfiler(a_star);
+        displaySearchQuality(a_star);
+        displayAnyAngleStats(a_star);
+        displaySmoothingStats(a_star);
+        displayLandmarkStats(landmarks, heuristicComparison);
+        displayHierarchyStats(hierarchy);
+        displaySubgoalStats(subgoalGraph);
+        displayFirstMoveStats(firstMoves);
+        if (wantFlowField)
+            displayFlowFieldStats(flowField);
+        if (showWavefront)
+            displayWavefrontStats(wavefront);
+        if (!cooperative.getAgents().empty())
+            displayCooperativeStats(cooperative);
+        if (showMapf)
+            displayConflictStats(cbs);
+        if (cachePaths || pathCache.getEntries() > 0)
+            displayCacheStats(pathCache);
+        if (showWorld || world.getChunkCount() > 0)
+            displaySparseWorldStats(world, worldSearch);
+        displayBenchmark(benchmarkRows);
         if (display_node_data) {
             auto maybenode = grid.on_mouse_hover(mousePos);
             if (maybenode.has_value()) {
@@ -210,21 +1048,92 @@ int main()
             a_star.setMethod(Diagonal_Distance);
         else if (method == Euclidean_Distance)
             a_star.setMethod(Euclidean_Distance);
+        else if (method == Landmark_ALT)
+            a_star.setMethod(Landmark_ALT);
 
-        if (wantDelay) {
-            if (a_star.isSearchRunning()) {
-                bool finished = a_star.stepSearch();
-                if (finished) {
-                    a_star.tracePath();
-                }
-            }
+        if (!a_star.isSearchRunning()) // new tables would change the heuristic mid-search
+            landmarks.poll();
+        subgoalGraph.update();
+        pathCache.update();
+        if (wantFlowField)
+            flowField.update();
+        if (a_star.isSearchRunning())
+            a_star.stepSearch();
+        if (runAgents && ++agentFrame >= framesPerStep) {
+            cooperative.step();
+            agentFrame = 0;
+        }
+        if (replayPlaying) {
+            recording.seek(recording.getStep() + replaySpeed);
+            replayPlaying = recording.getStep() < recording.getLength();
+        }
+        // Whichever way the last recorded search ran; h error also depends on the current walls
+        bool overlayStale = recording.getSequence() != overlaySequence || grid.getVersion() != overlayVersion || replayView != overlayView;
+        if (showReplay && replayView >= 0 && !recording.isEmpty() && !a_star.isSearchRunning() && overlayStale) {
+            grid.setOverlay(recording.computeOverlay(static_cast<RecordingOverlay>(replayView), grid));
+            overlaySequence = recording.getSequence();
+            overlayVersion = grid.getVersion();
+            overlayView = replayView;
         }
 
         window.clear();
+        window.setView(window.getDefaultView());
         window.draw(backGround);
-        grid.draw();
-        ImGui::SFML::Render(window);
-        window.display();
+        window.setView(camera.getView());
+        if (showWorld) {
+            Position origin(worldOrigin[0], worldOrigin[1]);
+            world.draw(window, origin, grid.getDimensions(), grid.getCellSize(), sf::Color(60, 60, 60));
+            std::vector<Position> visiblePath;
+            for (const auto& cell : worldPath)
+                visiblePath.push_back(cell - origin);
+            grid.drawPath(visiblePath);
+        }
+        else
+            grid.draw();
+        if (wantFlowField && flowField.isValid()) {
+            if (flowOverlay == Heatmap_Overlay)
+                grid.drawHeatmap(flowField.getDistances());
+            else if (flowOverlay == Arrow_Overlay)
+                grid.drawArrows(flowField.getSteps());
+        }
+        if (showWavefront && !wavefront.getDistances().empty())
+            grid.drawHeatmap(wavefront.getDistances());
+        if (showReplay && !recording.isEmpty() && replayView >= 0)
+            grid.drawOverlay();
+        else if (showReplay && !recording.isEmpty()) {
+            grid.drawHeatmap(recording.getOverlay());
+            grid.drawPath(recording.getBranch());
+        }
+        if (!cooperative.getAgents().empty()) {
+            std::vector<Position> positions, goals;
+            for (const auto& agent : cooperative.getAgents()) {
+                positions.push_back(agent.position);
+                goals.push_back(agent.goal);
+                if (cooperative.getAgents().size() <= 200)
+                    grid.drawPath(agent.plan);
+            }
+            grid.drawMarkers(goals, sf::Color::Red);
+            grid.drawMarkers(positions, sf::Color::Green);
+        }
+        for (const auto& path : mapfPaths)
+            grid.drawPath(path);
+        if (agentStart != Position(-1, -1))
+            grid.drawMarkers({ agentStart }, sf::Color::Yellow);
+        if (method == Landmark_ALT && landmarks.isValid())
+            grid.drawMarkers(landmarks.getLandmarks(), sf::Color::Cyan);
+        if (!a_star.getSmoothedPath().empty())
+            grid.drawPath(a_star.getSmoothedPath());
+        else if (!a_star.getWaypoints().empty())
+            grid.drawPath(a_star.getWaypoints());
+        window.setView(window.getDefaultView());
+        {
+            TraceSpan span("ImGui::SFML::Render");
+            ImGui::SFML::Render(window);
+        }
+        {
+            TraceSpan span("window.display");
+            window.display();
+        }
     }
 
     ImGui::SFML::Shutdown();